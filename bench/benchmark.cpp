@@ -0,0 +1,221 @@
+// Benchmarks for the task store's load, save, search, sort and render paths.
+//
+//   TodoBenchmark [--dir D] [--users N] [--tasks-per-user M] [--name-length L]
+//                 [--category-skew S] [--seed X] [--repeat R] [--only NAME] [--generate-only]
+//
+// Generates a synthetic dataset (users.txt plus tasks_<user>.txt, in the format chosen by
+// TODO_SNAPSHOT_FORMAT) into D, then times each benchmark R times and prints the min,
+// median and max wall time. The same seed and sizes always produce the same files.
+#include "todo.h"
+
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+struct BenchmarkConfig {
+    string dir = "todo_bench_data";
+    int users = 20;
+    int tasksPerUser = 2000;
+    int nameLength = 24;
+    double categorySkew = 1.0;  // Zipf exponent over the category list; 0 is uniform
+    uint64_t seed = 42;
+    int repeat = 5;
+    string only;
+    bool generateOnly = false;
+};
+
+// xorshift64*: small, fast and identical on every platform, unlike <random> distributions.
+class BenchmarkRandom {
+private:
+    uint64_t state;
+
+public:
+    explicit BenchmarkRandom(uint64_t seed) : state(seed * 0x9e3779b97f4a7c15ull + 1) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dull;
+    }
+
+    int below(int bound) { return static_cast<int>(next() % static_cast<uint64_t>(bound)); }
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+string benchmarkUserName(int index) {
+    char name[16];
+    snprintf(name, sizeof(name), "user_%04d", index);
+    return name;
+}
+
+void generateDataset(const BenchmarkConfig& config) {
+    static const vector<string> words = {
+        "review", "draft", "report", "call", "fix", "deploy", "plan", "budget", "email", "client",
+        "update", "design", "meeting", "invoice", "backup", "release", "notes", "schedule", "order",
+        "clean", "garden", "groceries", "dentist", "renew", "insurance", "quarterly", "migration"};
+    static const vector<string> categories = {
+        "Work", "Personal", "General", "Home", "Shopping", "Finance", "Health", "Travel",
+        "Study", "Family", "Errands", "Projects"};
+
+    BenchmarkRandom random(config.seed);
+    vector<double> cumulative;
+    double total = 0;
+    for (size_t rank = 1; rank <= categories.size(); ++rank) {
+        total += 1.0 / pow(static_cast<double>(rank), config.categorySkew);
+        cumulative.push_back(total);
+    }
+
+    filesystem::create_directories(config.dir);
+    ofstream usersFile(filesystem::path(config.dir) / "users.txt", ios::trunc);
+    const int anchorDay = Date(1, 1, 2026).toDays();
+    for (int user = 0; user < config.users; ++user) {
+        string name = benchmarkUserName(user);
+        string salt;
+        for (int i = 0; i < 16; ++i) salt += static_cast<char>(random.below(256));
+        Sha256::Digest digest = pbkdf2Sha256("password", salt, 1000);
+        usersFile << name << "," << PASSWORD_HASH_PREFIX << "1000$"
+                  << toHex(reinterpret_cast<const uint8_t*>(salt.data()), salt.size()) << "$"
+                  << toHex(digest.data(), digest.size()) << "\n";
+
+        TaskStore store;
+        store.reserve(config.tasksPerUser);
+        for (int id = 1; id <= config.tasksPerUser; ++id) {
+            string taskName;
+            while (static_cast<int>(taskName.size()) < config.nameLength) {
+                if (!taskName.empty()) taskName += ' ';
+                taskName += words[random.below(static_cast<int>(words.size()))];
+            }
+            taskName.resize(config.nameLength);
+            double pick = random.unit() * total;
+            size_t category = lower_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin();
+            store.push_back(Task(id, taskName, random.below(5) + 1, anchorDay + random.below(730) - 365,
+                                 random.below(10) < 3, categories[min(category, categories.size() - 1)], name));
+        }
+        writeTaskSnapshot((filesystem::path(config.dir) / ("tasks_" + name + ".txt")).string(), store, "",
+                          configuredSnapshotFormat());
+    }
+}
+
+// Swallows everything ToDoList prints while a benchmark runs.
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize count) override { return count; }
+};
+
+struct ToDoListBenchmark {
+    static void loadFromFile(ToDoList& todo) { todo.loadFromFile(); }
+    static void loadAllUsersTasks(ToDoList& todo) { todo.loadAllUsersTasks(); }
+    static void saveToFile(ToDoList& todo) { todo.saveToFile(); }
+};
+
+class BenchmarkRunner {
+private:
+    const BenchmarkConfig& config;
+    NullBuffer nullBuffer;
+
+public:
+    explicit BenchmarkRunner(const BenchmarkConfig& benchmarkConfig) : config(benchmarkConfig) {}
+
+    template <typename Setup, typename Body>
+    void run(const string& name, Setup setup, Body body) {
+        if (!config.only.empty() && name.find(config.only) == string::npos) return;
+        vector<double> millis;
+        for (int i = 0; i < config.repeat; ++i) {
+            streambuf* original = cout.rdbuf(&nullBuffer);
+            setup();
+            auto start = chrono::steady_clock::now();
+            body();
+            auto stop = chrono::steady_clock::now();
+            cout.rdbuf(original);
+            millis.push_back(chrono::duration<double, milli>(stop - start).count());
+        }
+        sort(millis.begin(), millis.end());
+        cout << left << setw(34) << name << right << fixed << setprecision(3) << setw(12) << millis.front()
+             << setw(12) << millis[millis.size() / 2] << setw(12) << millis.back() << "\n";
+    }
+
+    template <typename Body>
+    void run(const string& name, Body body) {
+        run(name, [] {}, body);
+    }
+};
+
+bool parseBenchmarkArgs(int argc, char* argv[], BenchmarkConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        string value = hasValue ? argv[i + 1] : "";
+        int number = 0;
+        if (arg == "--generate-only") {
+            config.generateOnly = true;
+            continue;
+        }
+        if (!hasValue) return false;
+        ++i;
+        if (arg == "--dir") config.dir = value;
+        else if (arg == "--only") config.only = value;
+        else if (arg == "--category-skew") config.categorySkew = atof(value.c_str());
+        else if (!parseInt(value, number) || number < 0) return false;
+        else if (arg == "--users") config.users = max(number, 1);
+        else if (arg == "--tasks-per-user") config.tasksPerUser = number;
+        else if (arg == "--name-length") config.nameLength = max(number, 1);
+        else if (arg == "--seed") config.seed = static_cast<uint64_t>(number);
+        else if (arg == "--repeat") config.repeat = max(number, 1);
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    if (!parseBenchmarkArgs(argc, argv, config)) {
+        cout << "Usage: " << argv[0] << " [--dir D] [--users N] [--tasks-per-user M] [--name-length L]"
+             << " [--category-skew S] [--seed X] [--repeat R] [--only NAME] [--generate-only]\n";
+        return 2;
+    }
+
+    auto start = chrono::steady_clock::now();
+    generateDataset(config);
+    cout << "Generated " << config.users << " users x " << config.tasksPerUser << " tasks in " << config.dir
+         << " (" << fixed << setprecision(1)
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms)\n";
+    if (config.generateOnly) return 0;
+
+    filesystem::current_path(config.dir);
+    BenchmarkRunner runner(config);
+    cout << left << setw(34) << "benchmark (ms)" << right << setw(12) << "min" << setw(12) << "median"
+         << setw(12) << "max" << "\n";
+
+    // The dataset is regenerated on every run, so benchmarks may rewrite user_0000's file.
+    string user = benchmarkUserName(0);
+    NullBuffer quiet;
+    streambuf* original = cout.rdbuf(&quiet);
+    ToDoList userList(user);
+    ToDoList adminList("admin", true);
+    cout.rdbuf(original);
+    userList.setPageSize(0);
+    adminList.setPageSize(0);
+
+    runner.run("loadFromFile", [&] { ToDoListBenchmark::loadFromFile(userList); });
+    runner.run("loadAllUsersTasks", [&] { ToDoListBenchmark::loadAllUsersTasks(adminList); });
+    runner.run("saveToFile", [&] { ToDoListBenchmark::saveToFile(userList); });
+    runner.run("searchTasks/user 'report'", [&] { userList.searchTasks("report"); });
+    runner.run("searchTasks/admin 'report'", [&] { adminList.searchTasks("report"); });
+    runner.run("searchTasks/admin 'zz' (no index)", [&] { adminList.searchTasks("zz"); });
+    runner.run("showTasks/user all", [&] { userList.showTasks(); });
+    runner.run("showTasks/admin all", [&] { adminList.showTasks(); });
+    runner.run("showTasks/admin completed", [&] { adminList.showTasks("completed"); });
+    runner.run("showTasks/admin category=Travel", [&] { adminList.showTasks("all", "Travel"); });
+    runner.run("showMostUrgent/admin top 10", [&] { adminList.showMostUrgent(10); });
+    for (const string criterion : {"priority", "date", "name"}) {
+        runner.run("sortTasks/user " + criterion, [&] { ToDoListBenchmark::loadFromFile(userList); },
+                   [&] { userList.sortTasks(criterion); });
+    }
+    runner.run("sortTasks/admin priority", [&] { ToDoListBenchmark::loadAllUsersTasks(adminList); },
+               [&] { adminList.sortTasks("priority"); });
+    runner.run("showTasks/admin all by priority", [&] { adminList.showTasks(); });
+    return 0;
+}
@@ -1,726 +1,19 @@
-#include <iostream>
-#include <iomanip>
-#include <string>
-#include <vector>
-#include <algorithm>
-#include <fstream>
-#include <sstream>
-#include <limits>
-#include <filesystem>
-#include <ctime>
+#include "todo.h"
 
 using namespace std;
 
-// reg add HKEY_CURRENT_USER\Console /v VirtualTerminalLevel /t REG_DWORD /d 1
-// ANSI color codes for styling
-#define RESET "\033[0m"
-#define RED "\033[31m"
-#define GREEN "\033[32m"
-#define YELLOW "\033[33m"
-#define BLUE "\033[34m"
-#define CYAN "\033[36m"
-#define BOLD "\033[1m"
-
-struct Date {
-    int day, month, year;
-
-    Date(int d = 1, int m = 1, int y = 1970) : day(d), month(m), year(y) {}
-
-    static Date fromString(const string& dateStr) {
-        Date date;
-        if (dateStr.size() != 10 || dateStr[2] != '-' || dateStr[5] != '-') {
-            return Date(0, 0, 0); // Invalid date
-        }
-
-        try {
-            date.day = stoi(dateStr.substr(0, 2));
-            date.month = stoi(dateStr.substr(3, 2));
-            date.year = stoi(dateStr.substr(6, 4));
-        } catch (...) {
-            return Date(0, 0, 0); // Invalid date
-        }
-        return date;
-    }
-
-    bool isValid() const {
-        if (month < 1 || month > 12 || day < 1 || year < 1970 || year > 9999) {
-            return false;
-        }
-
-        int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-        if (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
-            daysInMonth[1] = 29;
-        }
-        return day <= daysInMonth[month - 1];
-    }
-
-    bool isOverdue() const {
-        time_t now = time(nullptr);
-        tm* current = localtime(&now);
-        Date today(current->tm_mday, current->tm_mon + 1, current->tm_year + 1900);
-
-        if (year < today.year) return true;
-        if (year > today.year) return false;
-        if (month < today.month) return true;
-        if (month > today.month) return false;
-        return day < today.day;
-    }
-
-    string toString() const {
-        ostringstream oss;
-        oss << setfill('0') << setw(2) << day << "-"
-            << setw(2) << month << "-" << year;
-        return oss.str();
-    }
-};
-
-string trim(const string& str) {
-    size_t first = str.find_first_not_of(" \t\n\r");
-    size_t last = str.find_last_not_of(" \t\n\r");
-    if (first == string::npos || last == string::npos) return "";
-    return str.substr(first, last - first + 1);
-}
-
-bool parseInt(const string& input, int& result) {
-    try {
-        size_t pos;
-        result = stoi(input, &pos);
-        if (pos != input.size()) return false;
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-bool isValidDueDate(const string& dueDate) {
-    Date date = Date::fromString(dueDate);
-    return date.isValid();
-}
-
-bool isValidPriority(int priority) {
-    return priority >= 1 && priority <= 5;
-}
-
-struct Task {
-    int id;
-    string name;
-    int priority;
-    string dueDate;
-    bool done;
-    string category;
-    string owner;
-
-    Task(int _id, const string& _name, int _priority, const string& _dueDate, bool _done = false,
-         const string& _category = "General", const string& _owner = "")
-        : id(_id), name(_name), priority(_priority), dueDate(_dueDate), done(_done),
-          category(_category), owner(_owner) {}
-};
-
-class ToDoList {
-private:
-    vector<Task> tasks;
-    int nextId;
-    string currentUser;
-    bool isAdmin;
-    string taskFileName;
-
-    string getTaskFileName(const string& user = "") {
-        string sanitizedUser = user.empty() ? currentUser : user;
-        replace(sanitizedUser.begin(), sanitizedUser.end(), ' ', '_');
-        return "tasks_" + sanitizedUser + ".txt";
-    }
-
-    void saveToFile(const string& user = "") {
-        string fileName = getTaskFileName(user.empty() ? currentUser : user);
-        ofstream outFile(fileName);
-        if (!outFile.is_open()) {
-            cout << RED << "[ERROR] Cannot open file for writing: " << fileName << RESET << endl;
-            return;
-        }
-
-        outFile << "[\n";
-        for (size_t i = 0; i < tasks.size(); ++i) {
-            const Task& task = tasks[i];
-            if (user.empty() || task.owner == user) {
-                outFile << "  {";
-                outFile << "\"id\":" << task.id << ",";
-                outFile << "\"name\":\"" << task.name << "\",";
-                outFile << "\"priority\":" << task.priority << ",";
-                outFile << "\"dueDate\":\"" << task.dueDate << "\",";
-                outFile << "\"done\":" << (task.done ? "true" : "false") << ",";
-                outFile << "\"category\":\"" << task.category << "\",";
-                outFile << "\"owner\":\"" << task.owner << "\"";
-                outFile << "}" << (i < tasks.size() - 1 ? "," : "") << "\n";
-            }
-        }
-        outFile << "]\n";
-        outFile.close();
-    }
-
-    void loadFromFile(const string& user = "") {
-        if (user.empty() && !isAdmin) {
-            tasks.clear();
-        }
-        string fileName = getTaskFileName(user);
-        ifstream inFile(fileName);
-        if (!inFile.is_open()) {
-            if (user.empty()) nextId = 1;
-            cout << YELLOW << "[INFO] No task file found for user: " << (user.empty() ? currentUser : user) << RESET << endl;
-            return;
-        }
-
-        string line, jsonContent;
-        while (getline(inFile, line)) {
-            jsonContent += line + "\n";
-        }
-        inFile.close();
-
-        vector<string> taskLines;
-        size_t pos = 0;
-        while (pos < jsonContent.size()) {
-            size_t start = jsonContent.find('{', pos);
-            if (start == string::npos) break;
-            size_t end = jsonContent.find('}', start);
-            if (end == string::npos) break;
-            string taskStr = jsonContent.substr(start, end - start + 1);
-            taskStr = trim(taskStr);
-            if (!taskStr.empty()) taskLines.push_back(taskStr);
-            pos = end + 1;
-        }
-
-        for (const auto& taskStr : taskLines) {
-            int id = 0;
-            string name, dueDate, category = "General", owner = user.empty() ? currentUser : user;
-            int priority = 0;
-            bool done = false;
-
-            auto extractValue = [](const string& str, const string& key) {
-                size_t pos = str.find("\"" + key + "\":");
-                if (pos == string::npos) return string("");
-                pos += key.size() + 3;
-                if (str[pos] == '"') {
-                    pos++;
-                    size_t end = str.find("\"", pos);
-                    if (end == string::npos) return string("");
-                    return str.substr(pos, end - pos);
-                }
-                size_t end = str.find(",", pos);
-                if (end == string::npos) end = str.find("}", pos);
-                return trim(str.substr(pos, end - pos));
-            };
-
-            string idStr = extractValue(taskStr, "id");
-            if (parseInt(idStr, id)) {
-                name = extractValue(taskStr, "name");
-                string priorityStr = extractValue(taskStr, "priority");
-                parseInt(priorityStr, priority);
-                dueDate = extractValue(taskStr, "dueDate");
-                string doneStr = extractValue(taskStr, "done");
-                done = (doneStr == "true");
-                string categoryStr = extractValue(taskStr, "category");
-                if (!categoryStr.empty()) category = categoryStr;
-                string ownerStr = extractValue(taskStr, "owner");
-                if (!ownerStr.empty()) owner = ownerStr;
-
-                if (!name.empty() && isValidDueDate(dueDate) && isValidPriority(priority)) {
-                    tasks.push_back(Task(id, name, priority, dueDate, done, category, owner));
-                    nextId = max(nextId, id + 1);
-                } else {
-                    cout << YELLOW << "[WARNING] Skipping invalid task in " << fileName << ": " << taskStr << RESET << endl;
-                }
-            }
-        }
-    }
-
-    void loadAllUsersTasks() {
-        tasks.clear();
-        nextId = 1;
-        bool foundFiles = false;
-        for (const auto& entry : filesystem::directory_iterator(".")) {
-            string fileName = entry.path().filename().string();
-            if (fileName.find("tasks_") == 0 && fileName.ends_with(".txt")) {
-                string user = fileName.substr(6, fileName.size() - 10);
-                loadFromFile(user);
-                foundFiles = true;
-            }
-        }
-        if (!foundFiles) {
-            cout << YELLOW << "[INFO] No task files found in directory." << RESET << endl;
-        }
-    }
-
-public:
-    ToDoList(const string& user, bool admin = false) : currentUser(user), isAdmin(admin), nextId(1) {
-        taskFileName = getTaskFileName();
-        if (isAdmin) {
-            loadAllUsersTasks();
-        } else {
-            loadFromFile();
-        }
-        checkOverdueTasks();
-    }
-
-    size_t getTaskCount() const { return tasks.size(); }
-    bool getIsAdmin() const { return isAdmin; }
-    string getCurrentUser() const { return currentUser; }
-
-    void addTask(const string& name, int priority, const string& dueDate, const string& category = "General") {
-        if (name.empty()) {
-            cout << RED << "[ERROR] Task name cannot be empty." << RESET << endl;
-            return;
-        }
-        if (!isValidPriority(priority)) {
-            cout << RED << "[ERROR] Priority must be between 1 and 5." << RESET << endl;
-            return;
-        }
-        Date date = Date::fromString(dueDate);
-        if (!date.isValid()) {
-            cout << RED << "[ERROR] Invalid due date format. Use DD-MM-YYYY." << RESET << endl;
-            return;
-        }
-
-        tasks.push_back(Task(nextId++, name, priority, date.toString(), false, category, currentUser));
-        saveToFile();
-        cout << GREEN << "[INFO] Task added successfully." << RESET << endl;
-    }
-
-    void editTask(int id, const string& name, int priority, const string& dueDate, const string& category) {
-        for (Task& task : tasks) {
-            if (task.id == id && task.owner == currentUser) {
-                if (!name.empty()) task.name = name;
-                if (isValidPriority(priority)) task.priority = priority;
-                if (!dueDate.empty() && dueDate != "01-01-1970") {
-                    Date date = Date::fromString(dueDate);
-                    if (date.isValid()) {
-                        task.dueDate = date.toString();
-                    } else {
-                        cout << RED << "[ERROR] Invalid due date format. Use DD-MM-YYYY." << RESET << endl;
-                        return;
-                    }
-                }
-                if (!category.empty()) task.category = category;
-                saveToFile();
-                cout << GREEN << "[INFO] Task ID " << id << " updated successfully." << RESET << endl;
-                return;
-            }
-        }
-        cout << RED << "[ERROR] Task not found or you lack permission." << RESET << endl;
-    }
-
-    void checkOverdueTasks() {
-        vector<Task> overdueTasks;
-        for (const Task& task : tasks) {
-            if (!task.done && (isAdmin || task.owner == currentUser)) {
-                Date date = Date::fromString(task.dueDate);
-                if (date.isValid() && date.isOverdue()) {
-                    overdueTasks.push_back(task);
-                }
-            }
-        }
-
-        if (!overdueTasks.empty()) {
-            cout << YELLOW << "\n[WARNING] You have " << overdueTasks.size() << " overdue task(s):" << RESET << endl;
-            cout << CYAN << string(100, '=') << RESET << "\n";
-            cout << CYAN << "| " << left << setw(6) << "ID" << setw(26) << "Task Name" << setw(11) << "Priority"
-                 << setw(13) << "Due Date" << setw(11) << "Status" << setw(12) << "Category"
-                 << setw(18) << (isAdmin ? "Owner" : "") << "|" << RESET << "\n";
-            cout << CYAN << string(100, '=') << RESET << "\n";
-
-            for (const Task& task : overdueTasks) {
-                string status = YELLOW + string("Overdue") + RESET;
-                cout << "| " << left << setw(6) << task.id << setw(26) << task.name.substr(0, 25)
-                     << setw(11) << task.priority << setw(13) << task.dueDate
-                     << setw(20) << status << setw(12) << task.category.substr(0, 11)
-                     << setw(18) << (isAdmin ? task.owner.substr(0, 14) : "") << "|\n";
-            }
-            cout << CYAN << string(100, '=') << RESET << "\n";
-        }
-    }
-
-    void markAsDoneById(int id) {
-        for (Task& task : tasks) {
-            if (task.id == id && task.owner == currentUser && !task.done) {
-                task.done = true;
-                saveToFile();
-                cout << GREEN << "[INFO] Task ID " << id << " marked as done." << RESET << endl;
-                return;
-            }
-        }
-        cout << RED << "[ERROR] Task not found, already done, or you lack permission." << RESET << endl;
-    }
-
-    void unmarkTaskById(int id) {
-        for (Task& task : tasks) {
-            if (task.id == id && task.owner == currentUser && task.done) {
-                task.done = false;
-                saveToFile();
-                cout << GREEN << "[INFO] Task ID " << id << " unmarked as done." << RESET << endl;
-                return;
-            }
-        }
-        cout << RED << "[ERROR] Task not found, not done, or you lack permission." << RESET << endl;
-    }
-
-    void deleteTaskById(int id) {
-        auto it = remove_if(tasks.begin(), tasks.end(), [this, id](const Task& task) {
-            return task.id == id && task.owner == currentUser;
-        });
-        if (it == tasks.end()) {
-            cout << RED << "[ERROR] Task not found or you lack permission." << RESET << endl;
-            return;
-        }
-        tasks.erase(it, tasks.end());
-        saveToFile();
-        cout << GREEN << "[INFO] Task deleted successfully." << RESET << endl;
-    }
-
-    void clearAllTask() {
-        cout << YELLOW << "[WARNING] Are you sure? [Y/N]: " << RESET;
-        char response;
-        cin >> response;
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear input buffer
-
-        if (toupper(response) == 'Y') {
-            tasks.clear();
-            nextId = 1;
-            saveToFile();
-            cout << GREEN << "[SUCCESS] All tasks have been cleared successfully!" << RESET << endl;
-        } else {
-            cout << RED << "[FAILED] Cancel the process" << endl;
-        }
-    }
-
-    void sortTasks(const string& criterion) {
-        if (criterion == "priority") {
-            sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-                return a.priority < b.priority;
-            });
-        } else if (criterion == "date") {
-            sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-                return a.dueDate < b.dueDate;
-            });
-        } else if (criterion == "name") {
-            sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-                return a.name < b.name;
-            });
-        } else if (criterion == "owner" && isAdmin) {
-            sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-                return a.owner < b.owner;
-            });
-        } else {
-            cout << RED << "[ERROR] Invalid sort criterion. Use 'priority', 'date', 'name'"
-                 << (isAdmin ? ", or 'owner'." : ".") << RESET << endl;
-            return;
-        }
-        if (!isAdmin) saveToFile();
-        else for (const auto& task : tasks) saveToFile(task.owner);
-        cout << GREEN << "[INFO] Tasks sorted by " << criterion << "." << RESET << endl;
-    }
-
-    void showTasks(const string& filter = "all", const string& category = "", const string& owner = "") {
-        vector<Task> filteredTasks;
-        for (const Task& task : tasks) {
-            if ((filter == "all" || (filter == "completed" && task.done) || (filter == "incomplete" && !task.done)) &&
-                (category.empty() || task.category == category) &&
-                (owner.empty() || task.owner == owner) &&
-                (isAdmin || task.owner == currentUser)) {
-                filteredTasks.push_back(task);
-            }
-        }
-
-        if (filteredTasks.empty()) {
-            cout << YELLOW << "[INFO] No tasks to show." << RESET << endl;
-            return;
-        }
-
-        size_t total = isAdmin ? tasks.size() : count_if(tasks.begin(), tasks.end(),
-            [this](const Task& t) { return t.owner == currentUser; });
-        size_t completed = count_if(tasks.begin(), tasks.end(),
-            [this](const Task& t) { return t.done && (isAdmin || t.owner == currentUser); });
-        double progress = total > 0 ? (static_cast<double>(completed) / total) * 100 : 0;
-
-        cout << "\n" << CYAN << string(100, '=') << RESET << "\n";
-        cout << CYAN << "| " << left << setw(6) << "ID" << setw(26) << "Task Name" << setw(11) << "Priority"
-             << setw(13) << "Due Date" << setw(11) << "Status" << setw(12) << "Category"
-             << setw(18) << (isAdmin ? "Owner" : "") << "|" << RESET << "\n";
-        cout << CYAN << string(100, '=') << RESET << "\n";
-
-        for (const Task& task : filteredTasks) {
-            string status;
-            if (task.done) {
-                status = GREEN + string("Done") + RESET;
-            } else {
-                Date date = Date::fromString(task.dueDate);
-                status = date.isValid() && date.isOverdue() ? (YELLOW + string("Overdue") + RESET) : (YELLOW + string("Not Done") + RESET);
-            }
-            cout << "| " << left << setw(6) << task.id << setw(26) << task.name.substr(0, 25)
-                 << setw(11) << task.priority << setw(13) << task.dueDate
-                 << setw(20) << status << setw(12) << task.category.substr(0, 11)
-                 << setw(18) << (isAdmin ? task.owner.substr(0, 14) : "") << "|\n";
-        }
-
-        cout << CYAN << string(100, '=') << RESET << "\n";
-        cout << BLUE << "Progress: " << fixed << setprecision(2) << progress << "% completed ("
-             << completed << " of " << total << " tasks)" << RESET << "\n";
-    }
-
-    void searchTasks(const string& query, const string& owner = "") {
-        vector<Task> results;
-        string queryLower = query;
-        transform(queryLower.begin(), queryLower.end(), queryLower.begin(), ::tolower);
-
-        for (const Task& task : tasks) {
-            if (isAdmin || task.owner == currentUser) {
-                string nameLower = task.name;
-                string categoryLower = task.category;
-                transform(nameLower.begin(), nameLower.end(), nameLower.begin(), ::tolower);
-                transform(categoryLower.begin(), categoryLower.end(), categoryLower.begin(), ::tolower);
-
-                // Contains search in name or category
-                if (nameLower.find(queryLower) != string::npos ||
-                    categoryLower.find(queryLower) != string::npos) {
-                    if (owner.empty() || task.owner == owner) {
-                        results.push_back(task);
-                    }
-                }
-            }
-        }
-
-
-        if (results.empty()) {
-            cout << YELLOW << "[INFO] No tasks match the query '" << query << "'." << RESET << endl;
-            return;
-        }
-
-        cout << "\n" << CYAN << string(100, '=') << RESET << "\n";
-        cout << CYAN << "| " << left << setw(6) << "ID" << setw(26) << "Task Name" << setw(11) << "Priority"
-             << setw(13) << "Due Date" << setw(11) << "Status" << setw(12) << "Category"
-             << setw(18) << (isAdmin ? "Owner" : "") << "|" << RESET << "\n";
-        cout << CYAN << string(100, '=') << RESET << "\n";
-
-        for (const Task& task : results) {
-            string status;
-            if (task.done) {
-                status = GREEN + string("Done") + RESET;
-            } else {
-                Date date = Date::fromString(task.dueDate);
-                status = date.isValid() && date.isOverdue() ? (YELLOW + string("Overdue") + RESET) : (YELLOW + string("Not Done") + RESET);
-            }
-            cout << "|" << left << setw(6) << task.id << setw(26) << task.name.substr(0, 25)
-                 << setw(11) << task.priority << setw(14) << task.dueDate
-                 << setw(20) << status << setw(12) << task.category.substr(0, 11)
-                 << setw(18) << (isAdmin ? task.owner.substr(0, 14) : "") << "|\n";
-        }
-
-        cout << CYAN << string(100, '=') << RESET << "\n";
-    }
-
-    void listAllUsers() {
-        ifstream inFile("users.txt");
-        if (!inFile.is_open()) {
-            cout << RED << "[ERROR] Cannot open users file." << RESET << endl;
-            return;
-        }
-
-        vector<string> users;
-        string line;
-        while (getline(inFile, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-
-            size_t commaPos = line.find(',');
-            if (commaPos == string::npos) continue;
-
-            string username = trim(line.substr(0, commaPos));
-            if (username.front() == '"' && username.back() == '"') {
-                username = username.substr(1, username.size() - 2);
-            }
-
-            if (username != "admin") users.push_back(username);
-        }
-        inFile.close();
-
-        if (users.empty()) {
-            cout << YELLOW << "[INFO] No users found." << RESET << endl;
-            return;
-        }
-
-        cout << "\n" << CYAN << string(30, '=') << RESET << "\n";
-        cout << CYAN << "|" << left << setw(28) << "Username" << "|" << RESET << "\n";
-        cout << CYAN << string(30, '=') << RESET << "\n";
-        for (const auto& user : users) {
-            cout << "|" << left << setw(28) << user << "|\n";
-        }
-        cout << CYAN << string(30, '=') << RESET << "\n";
-    }
-
-    void removeUser(const string& username) {
-        if (username == "admin") {
-            cout << RED << "[ERROR] Cannot remove the admin account." << RESET << endl;
-            return;
-        }
-
-        ifstream inFile("users.txt");
-        if (!inFile.is_open()) {
-            cout << RED << "[ERROR] Cannot open users file." << RESET << endl;
-            return;
-        }
-
-        vector<string> lines;
-        string line;
-        bool found = false;
-        while (getline(inFile, line)) {
-            line = trim(line);
-            if (line.empty()) continue;
-
-            size_t commaPos = line.find(',');
-            if (commaPos == string::npos) continue;
-
-            string storedUser = trim(line.substr(0, commaPos));
-            if (storedUser.front() == '"' && storedUser.back() == '"') {
-                storedUser = storedUser.substr(1, storedUser.size() - 2);
-            }
-
-            if (storedUser != username) {
-                lines.push_back(line);
-            } else {
-                found = true;
-            }
-        }
-        inFile.close();
-
-        if (!found) {
-            cout << RED << "[ERROR] User '" << username << "' not found." << RESET << endl;
-            return;
-        }
-
-        ofstream outFile("users.txt");
-        if (!outFile.is_open()) {
-            cout << RED << "[ERROR] Cannot open users file for writing." << RESET << endl;
-            return;
-        }
-        for (const auto& l : lines) {
-            outFile << l << "\n";
-        }
-        outFile.close();
-
-        string taskFile = "tasks_" + username + ".txt";
-        if (filesystem::exists(taskFile)) {
-            filesystem::remove(taskFile);
-        }
-
-        tasks.erase(
-            remove_if(tasks.begin(), tasks.end(),
-                [username](const Task& task) { return task.owner == username; }),
-            tasks.end()
-        );
-
-        cout << GREEN << "[INFO] User '" << username << "' and their tasks removed successfully." << RESET << endl;
-    }
-};
-
-bool userExists(const string& username) {
-    string trimmedUsername = trim(username);
-    ifstream inFile("users.txt");
-    if (!inFile.is_open()) return false;
-
-    string line;
-    while (getline(inFile, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-
-        size_t commaPos = line.find(',');
-        if (commaPos == string::npos) continue;
-
-        string storedUser = trim(line.substr(0, commaPos));
-        if (storedUser.front() == '"' && storedUser.back() == '"') {
-            storedUser = storedUser.substr(1, storedUser.size() - 2);
-        }
-
-        if (storedUser == trimmedUsername) {
-            inFile.close();
-            return true;
-        }
-    }
-    inFile.close();
-    return false;
-}
-
-bool registerUser(const string& username, const string& password) {
-    string trimmedUsername = trim(username);
-    string trimmedPassword = trim(password);
-
-    if (trimmedUsername.empty() || trimmedPassword.empty()) {
-        cout << RED << "[ERROR] Username and password cannot be empty." << RESET << endl;
-        return false;
-    }
-
-    if (userExists(trimmedUsername)) {
-        cout << RED << "[ERROR] Username already exists." << RESET << endl;
-        return false;
-    }
-
-    ofstream outFile("users.txt", ios::app);
+// Appends the process metrics to TODO_STATS_FILE, when it is set, as a session ends.
+void dumpSessionStats(const string& user) {
+    const char* fileName = getenv("TODO_STATS_FILE");
+    if (!fileName || !*fileName) return;
+    ofstream outFile(fileName, ios::app);
     if (!outFile.is_open()) {
-        cout << RED << "[ERROR] Cannot open users file for writing." << RESET << endl;
-        return false;
-    }
-
-    string formattedUsername = trimmedUsername;
-    if (trimmedUsername.find(' ') != string::npos) {
-        formattedUsername = "\"" + trimmedUsername + "\"";
-    }
-
-    outFile << formattedUsername << "," << trimmedPassword << "\n";
-    outFile.close();
-    cout << GREEN << "[INFO] Registration successful." << RESET << endl;
-    return true;
-}
-
-bool loginUser(const string& username, const string& password) {
-    string trimmedUsername = trim(username);
-    string trimmedPassword = trim(password);
-
-    if (trimmedUsername == "admin" && trimmedPassword == "admin123") {
-        cout << GREEN << "[SUCCESS] Admin login successful." << RESET << endl;
-        return true;
-    }
-
-    if (trimmedUsername.empty() || trimmedPassword.empty()) {
-        cout << RED << "[ERROR] Username and password cannot be empty." << RESET << endl;
-        return false;
-    }
-
-    ifstream inFile("users.txt");
-    if (!inFile.is_open()) {
-        cout << RED << "[ERROR] Cannot open users file. Admin login still available." << RESET << endl;
-        return false;
-    }
-
-    string line;
-    while (getline(inFile, line)) {
-        line = trim(line);
-        if (line.empty()) continue;
-
-        size_t commaPos = line.find(',');
-        if (commaPos == string::npos) continue;
-
-        string storedUser = trim(line.substr(0, commaPos));
-        string storedPass = trim(line.substr(commaPos + 1));
-
-        if (storedUser.front() == '"' && storedUser.back() == '"') {
-            storedUser = storedUser.substr(1, storedUser.size() - 2);
-        }
-
-        if (storedUser == trimmedUsername && storedPass == trimmedPassword) {
-            inFile.close();
-            cout << GREEN << "[SUCCESS] User login successful." << RESET << endl;
-            return true;
-        }
+        cout << RED << "[ERROR] Cannot open stats file for writing: " << fileName << RESET << endl;
+        return;
     }
-    inFile.close();
-    cout << RED << "[ERROR] User login failed." << RESET << endl;
-    return false;
+    time_t now = time(nullptr);
+    outFile << "== session of " << user << " ended " << put_time(localtime(&now), "%Y-%m-%d %H:%M:%S") << "\n";
+    Metrics::instance().report(outFile);
 }
 
 void runToDoApp(ToDoList& todo) {
@@ -732,13 +25,15 @@ void runToDoApp(ToDoList& todo) {
         {"4", "Mark Task as Done"}, {"5", "Unmark Task"}, {"6", "View All Tasks"},
         {"7", "View Completed Tasks"}, {"8", "View Incomplete Tasks"},
         {"9", "Sort Tasks"}, {"10", "Search Tasks"}, {"11", "Filter by Category"},
-        {"12", "Clear All Tasks"},{"13", "Logout"}
+        {"12", "Clear All Tasks"},{"13", "Logout"}, {"14", "Import Tasks"}, {"15", "Export Tasks"},
+        {"16", "Most Urgent Tasks"}
     };
 
     vector<pair<string, string>> adminMenuOptions = {
         {"1", "View All Tasks"}, {"2", "View Completed Tasks"}, {"3", "View Incomplete Tasks"},
         {"4", "Sort Tasks"}, {"5", "Search Tasks"}, {"6", "Filter by Category"},
-        {"7", "List All Users"}, {"8", "Remove User"}, {"9", "Clear All Tasks"},{"10", "Logout"}
+        {"7", "List All Users"}, {"8", "Remove User"}, {"9", "Clear All Tasks"},{"10", "Logout"},
+        {"11", "Import Tasks"}, {"12", "Export Tasks"}, {"13", "View Stats"}, {"14", "Most Urgent Tasks"}
     };
 
     const auto& menuOptions = todo.getIsAdmin() ? adminMenuOptions : userMenuOptions;
@@ -800,8 +95,28 @@ void runToDoApp(ToDoList& todo) {
             } else if (choice == "9"){
                 todo.clearAllTask();
             } else if (choice == "10") {
+                dumpSessionStats(todo.getCurrentUser());
                 cout << GREEN << "[INFO] Logged out successfully." << RESET << endl;
                 break;
+            } else if (choice == "11" || choice == "12") {
+                cout << BLUE << "File name (.csv or .jsonl): " << RESET;
+                getline(cin, input);
+                if (choice == "11") todo.importTasks(trim(input));
+                else todo.exportTasks(trim(input));
+            } else if (choice == "13") {
+                cout << "\n";
+                Metrics::instance().report(cout);
+            } else if (choice == "14") {
+                cout << BLUE << "How many (leave blank for 10): " << RESET;
+                getline(cin, input);
+                int count = 10;
+                if (!trim(input).empty() && (!parseInt(trim(input), count) || count < 1)) {
+                    cout << RED << "[ERROR] Invalid count." << RESET << endl;
+                    continue;
+                }
+                cout << BLUE << "Owner (leave blank for all users): " << RESET;
+                getline(cin, owner);
+                todo.showMostUrgent(count, "incomplete", "", owner);
             } else {
                 cout << RED << "[ERROR] Invalid choice. Please select a valid option." << RESET << endl;
             }
@@ -892,8 +207,23 @@ void runToDoApp(ToDoList& todo) {
             }else if (choice == "12"){
                 todo.clearAllTask();
             } else if (choice == "13") {
+                dumpSessionStats(todo.getCurrentUser());
                 cout << GREEN << "[INFO] Logged out successfully." << RESET << endl;
                 break;
+            } else if (choice == "14" || choice == "15") {
+                cout << BLUE << "File name (.csv or .jsonl): " << RESET;
+                getline(cin, input);
+                if (choice == "14") todo.importTasks(trim(input));
+                else todo.exportTasks(trim(input));
+            } else if (choice == "16") {
+                cout << BLUE << "How many (leave blank for 10): " << RESET;
+                getline(cin, input);
+                int count = 10;
+                if (!trim(input).empty() && (!parseInt(trim(input), count) || count < 1)) {
+                    cout << RED << "[ERROR] Invalid count." << RESET << endl;
+                    continue;
+                }
+                todo.showMostUrgent(count);
             } else {
                 cout << RED << "[ERROR] Invalid choice. Please select a valid option." << RESET << endl;
             }
@@ -923,6 +253,7 @@ void showAuthMenu() {
             getline(cin, password);
             if (loginUser(username, password)) {
                 ToDoList todo(trim(username), trim(username) == "admin");
+                todo.checkOverdueTasks();
                 runToDoApp(todo);
             }
         } else if (choice == "2") {
@@ -940,18 +271,774 @@ void showAuthMenu() {
     }
 }
 
+// Splits a batch command into words; double quotes group words and \ escapes a character.
+vector<string> splitCommandWords(const string& line) {
+    vector<string> words;
+    string word;
+    bool inWord = false, quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            word += line[++i];
+            inWord = true;
+        } else if (c == '"') {
+            quoted = !quoted;
+            inWord = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (inWord) words.push_back(move(word));
+            word.clear();
+            inWord = false;
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (inWord) words.push_back(move(word));
+    return words;
+}
+
+// Runs one batch command other than 'login' against a logged-in list. `changes` counts the
+// journalled changes since the last checkpoint, and errors are reported as "[ERROR] "
+// followed by `where` and the message. Returns false if the command could not be run.
+// Given `query`, list, search and urgent leave a snapshot job there instead of printing.
+bool runBatchCommand(ToDoList& todo, const vector<string>& words, const string& where, size_t& changes,
+                     ToDoList::SnapshotQuery* query = nullptr) {
+    const string& command = words[0];
+
+    // Options are "--key value" pairs after the positional arguments.
+    vector<string> positional;
+    unordered_map<string, string> options;
+    bool malformed = false;
+    for (size_t i = 1; i < words.size(); ++i) {
+        if (words[i].starts_with("--")) {
+            if (i + 1 == words.size()) {
+                malformed = true;
+            } else {
+                options[words[i].substr(2)] = words[i + 1];
+                ++i;
+            }
+        } else {
+            positional.push_back(words[i]);
+        }
+    }
+    auto option = [&options](const string& key) {
+        auto it = options.find(key);
+        return it == options.end() ? string() : it->second;
+    };
+    auto sizeOption = [&](const string& key, size_t& out) {
+        int value = 0;
+        if (option(key).empty()) return true;
+        if (!parseInt(option(key), value) || value < 0) return false;
+        out = static_cast<size_t>(value);
+        return true;
+    };
+    auto fail = [&](const string& message) {
+        cout << RED << "[ERROR] " << where << message << RESET << endl;
+        return false;
+    };
+
+    bool admin = todo.getIsAdmin();
+    bool userCommand = command == "add" || command == "edit" || command == "done" ||
+                       command == "undone" || command == "delete";
+    size_t offset = 0, limit = 0;
+    int id = 0, priority = 0;
+    if (malformed) return fail("option without a value");
+    if (userCommand && admin) return fail("'" + command + "' is not available to the admin account");
+    if (command == "add") {
+        if (positional.size() < 3 || positional.size() > 4 || !parseInt(positional[1], priority)) {
+            return fail("usage: add <name> <priority> <dd-mm-yyyy> [category]");
+        }
+        todo.addTask(positional[0], priority, positional[2], positional.size() == 4 ? positional[3] : "General");
+        ++changes;
+    } else if (command == "edit") {
+        if (positional.size() != 1 || !parseInt(positional[0], id) ||
+            (!option("priority").empty() && !parseInt(option("priority"), priority))) {
+            return fail("usage: edit <id> [--name N] [--priority P] [--due D] [--category C]");
+        }
+        todo.editTask(id, option("name"), priority, option("due"), option("category"));
+        ++changes;
+    } else if (command == "done" || command == "undone" || command == "delete") {
+        if (positional.size() != 1 || !parseInt(positional[0], id)) {
+            return fail("usage: " + command + " <id>");
+        }
+        if (command == "done") todo.markAsDoneById(id);
+        else if (command == "undone") todo.unmarkTaskById(id);
+        else todo.deleteTaskById(id);
+        ++changes;
+    } else if (command == "list") {
+        if (!positional.empty() || !sizeOption("offset", offset) || !sizeOption("limit", limit)) {
+            return fail("usage: list [--filter F] [--category C] [--owner O] [--offset N] [--limit N]");
+        }
+        string filter = option("filter").empty() ? "all" : option("filter");
+        if (query) *query = todo.snapshotListing(filter, option("category"), option("owner"), offset, limit);
+        else todo.showTasks(filter, option("category"), option("owner"), offset, limit);
+    } else if (command == "search") {
+        if (positional.size() != 1 || !sizeOption("offset", offset) || !sizeOption("limit", limit)) {
+            return fail("usage: search <query> [--owner O] [--offset N] [--limit N]");
+        }
+        if (query) *query = todo.snapshotSearch(positional[0], option("owner"), offset, limit);
+        else todo.searchTasks(positional[0], option("owner"), offset, limit);
+    } else if (command == "urgent") {
+        size_t count = 10;
+        if (!positional.empty() || !sizeOption("count", count)) {
+            return fail("usage: urgent [--count N] [--filter F] [--category C] [--owner O]");
+        }
+        string filter = option("filter").empty() ? "incomplete" : option("filter");
+        if (query) *query = todo.snapshotUrgent(count, filter, option("category"), option("owner"));
+        else todo.showMostUrgent(count, filter, option("category"), option("owner"));
+    } else if (command == "sort") {
+        if (positional.size() != 1) {
+            return fail("usage: sort <criterion>");
+        }
+        todo.sortTasks(positional[0]);
+    } else if (command == "import" || command == "export") {
+        if (positional.size() != 1) {
+            return fail("usage: " + command + " <file> [--format csv|jsonl]");
+        }
+        if (command == "import") todo.importTasks(positional[0], option("format"));
+        else todo.exportTasks(positional[0], option("format"));
+    } else if (command == "clear") {
+        todo.clearAllTask(true);
+    } else if (command == "remove-user") {
+        if (!admin || positional.size() != 1) {
+            return fail(admin ? "usage: remove-user <name>" : "'remove-user' requires the admin account");
+        }
+        todo.removeUser(positional[0]);
+    } else if (command == "stats") {
+        Metrics::instance().report(cout);
+    } else if (command == "checkpoint") {
+        todo.flushJournal();
+        changes = 0;
+    } else {
+        return fail("unknown command '" + command + "'");
+    }
+    return true;
+}
+
+// Non-interactive mode for scripted bulk changes. The script's first command logs in,
+// every later command runs against that one ToDoList, and journal records are written
+// once at the end (or every `checkpointEvery` changes when that is non-zero).
+//
+//   login <user> <password>
+//   add <name> <priority> <dd-mm-yyyy> [category]
+//   edit <id> [--name N] [--priority P] [--due D] [--category C]
+//   done|undone|delete <id>
+//   list [--filter all|completed|incomplete] [--category C] [--owner O] [--offset N] [--limit N]
+//   search <query> [--owner O] [--offset N] [--limit N]
+//   urgent [--count N] [--filter F] [--category C] [--owner O]
+//   sort <priority|date|name|owner>
+//   import|export <file> [--format csv|jsonl]
+//   clear | remove-user <name> | checkpoint | stats
+//
+// Blank lines and lines starting with '#' are ignored. Returns the number of commands
+// that could not be run.
+int runBatch(istream& script, size_t checkpointEvery) {
+    unique_ptr<ToDoList> todo;
+    size_t changesSinceCheckpoint = 0;
+    int failures = 0;
+    string line;
+    size_t lineNumber = 0;
+
+    while (getline(script, line)) {
+        ++lineNumber;
+        vector<string> words = splitCommandWords(line);
+        if (words.empty() || words[0][0] == '#') continue;
+        string where = "Line " + to_string(lineNumber) + ": ";
+        auto fail = [&](const string& message) {
+            cout << RED << "[ERROR] " << where << message << RESET << endl;
+            ++failures;
+        };
+
+        if (words[0] == "login") {
+            if (todo) {
+                fail("already logged in");
+            } else if (words.size() != 3) {
+                fail("usage: login <user> <password>");
+            } else if (loginUser(words[1], words[2])) {
+                string username = trim(words[1]);
+                todo = make_unique<ToDoList>(username, username == "admin");
+                todo->setDeferredJournal(true);
+                todo->setPageSize(0);
+                todo->checkOverdueTasks();
+            } else {
+                return failures + 1;
+            }
+            continue;
+        }
+        if (!todo) {
+            fail("the first command must be 'login'");
+            return failures;
+        }
+
+        if (!runBatchCommand(*todo, words, where, changesSinceCheckpoint)) ++failures;
+        if (checkpointEvery && changesSinceCheckpoint >= checkpointEvery) {
+            todo->flushJournal();
+            changesSinceCheckpoint = 0;
+        }
+    }
+    if (todo) {
+        todo->flushJournal();
+        dumpSessionStats(todo->getCurrentUser());
+    }
+    return failures;
+}
+
+#ifdef __linux__
+// Daemon mode: one process keeps each logged-in user's ToDoList resident and serves any
+// number of clients over a Unix domain socket from a single epoll loop.
+//
+// A request is one line holding a batch command, or 'login <user> <password>', 'logout'
+// or 'quit'. The response is whatever the command printed followed by a line holding
+// only "."; output lines that start with '.' get a second one, as in SMTP.
+//
+// All clients of one user share that user's list, and changes are journalled as they
+// happen, so the files on disk stay current. Admin changes may touch any user's data and
+// drop the cached user lists, which reload on next use; a user's change makes the admin
+// list re-read just that user before its next request.
+//
+// Logins, exports and list, search and urgent run on a fixed pool of worker threads (all
+// but logins against a published snapshot), so none of them holds up other clients'
+// edits. The client that asked waits for the answer; it comes back through `finished`
+// and an eventfd wakes the loop.
+//
+// Clients name import and export files relative to EXCHANGE_DIR under the server's
+// working directory; paths that could leave it are refused.
+class TaskServer {
+private:
+    struct Client {
+        uint64_t connection = 0;  // tells a reused descriptor from the client a job was for
+        string input;
+        string output;
+        size_t sent = 0;   // bytes of `output` already written
+        string user;       // empty until login
+        bool closing = false;
+        bool busy = false;        // waiting for a worker; input is held until it answers
+        bool registered = true;   // present in the epoll set
+        uint32_t events = 0;
+    };
+
+    struct QueuedJob {
+        int fd;
+        uint64_t connection;
+        function<string(ostream&)> run;  // returns the user to sign the client in as, or ""
+    };
+
+    struct FinishedJob {
+        int fd;
+        uint64_t connection;
+        string output;
+        string user;  // signed in once the job is collected; set only by a successful login
+    };
+
+    static constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;
+    static constexpr size_t MAX_PENDING_OUTPUT = 1 << 20;  // stop reading a client that doesn't read
+    static constexpr const char* EXCHANGE_DIR = "exchange";
+
+    string socketPath;
+    int listenFd = -1, signalFd = -1, epollFd = -1, wakeFd = -1;
+    uint64_t nextConnection = 1;
+    unordered_map<int, Client> clients;
+    unordered_map<string, unique_ptr<ToDoList>> lists;  // by user
+    set<string> staleForAdmin;  // owners changed since the admin list last saw them
+
+    vector<thread> workers;
+    mutex queueMutex;
+    condition_variable jobQueued;
+    deque<QueuedJob> queue;  // at most one job per client, since a busy client sends nothing
+    bool stopping = false;   // guarded by queueMutex
+    mutex finishedMutex;
+    vector<FinishedJob> finished;
+
+    bool fail(const string& what) {
+        cout << RED << "[ERROR] " << what << ": " << strerror(errno) << RESET << endl;
+        return false;
+    }
+
+    void watch(int fd, uint32_t events, int operation = EPOLL_CTL_ADD) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, operation, fd, &event);
+    }
+
+    // Loads a user's list on first use. Loading output is dropped; login shows the
+    // overdue warning itself. The admin list first re-reads owners others have changed.
+    ToDoList& listFor(const string& user) {
+        auto it = lists.find(user);
+        if (it == lists.end()) {
+            ostringstream discarded;
+            streambuf* original = cout.rdbuf(discarded.rdbuf());
+            auto todo = make_unique<ToDoList>(user, user == "admin");
+            cout.rdbuf(original);
+            todo->setPageSize(0);
+            it = lists.emplace(user, move(todo)).first;
+            if (user == "admin") staleForAdmin.clear();
+        } else if (user == "admin") {
+            for (const string& owner : staleForAdmin) it->second->reloadOwnerTasks(owner);
+            staleForAdmin.clear();
+        }
+        return *it->second;
+    }
+
+    void noteChange(const string& user, const vector<string>& words) {
+        if (user != "admin") {
+            if (lists.count("admin")) staleForAdmin.insert(user);
+            return;
+        }
+        for (auto it = lists.begin(); it != lists.end();) {
+            it = it->first == "admin" ? next(it) : lists.erase(it);
+        }
+        if (words[0] == "remove-user" && words.size() > 1) {
+            for (auto& entry : clients) {
+                if (entry.second.user == words[1]) entry.second.user.clear();
+            }
+        }
+    }
+
+    // The job returns the user to sign the client in as, or an empty string.
+    void startJob(int fd, Client& client, function<string(ostream&)> job) {
+        client.busy = true;
+        {
+            lock_guard lock(queueMutex);
+            queue.push_back({fd, client.connection, move(job)});
+        }
+        jobQueued.notify_one();
+    }
+
+    void runJobs() {
+        while (true) {
+            QueuedJob job;
+            {
+                unique_lock lock(queueMutex);
+                jobQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;  // stopping, and everything queued has run
+                job = move(queue.front());
+                queue.pop_front();
+            }
+            ostringstream output;
+            string user = job.run(output);
+            {
+                lock_guard lock(finishedMutex);
+                finished.push_back({job.fd, job.connection, output.str(), move(user)});
+            }
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t woken = write(wakeFd, &one, sizeof(one));
+        }
+    }
+
+    // Resolves a client's import or export file name inside EXCHANGE_DIR. Absolute paths,
+    // '..' components and symlinks leading out of the directory are refused.
+    static bool exchangePath(const string& requested, string& resolved) {
+        filesystem::path path(requested);
+        if (requested.empty() || path.has_root_name() || path.has_root_directory()) return false;
+        for (const filesystem::path& part : path) {
+            if (part == "..") return false;
+        }
+        error_code ec;
+        filesystem::path base = filesystem::weakly_canonical(EXCHANGE_DIR, ec);
+        filesystem::path target = filesystem::weakly_canonical(base / path, ec);
+        if (ec) return false;
+        auto [baseEnd, targetAt] = mismatch(base.begin(), base.end(), target.begin(), target.end());
+        if (baseEnd != base.end() || targetAt == target.end()) return false;
+        resolved = (filesystem::path(EXCHANGE_DIR) / path).lexically_normal().string();
+        return true;
+    }
+
+    void collectFinishedJobs() {
+        uint64_t count;
+        [[maybe_unused]] ssize_t drained = read(wakeFd, &count, sizeof(count));
+        vector<FinishedJob> jobs;
+        {
+            lock_guard lock(finishedMutex);
+            jobs.swap(finished);
+        }
+        for (FinishedJob& job : jobs) {
+            auto it = clients.find(job.fd);
+            if (it == clients.end() || it->second.connection != job.connection) continue;  // client left
+            it->second.busy = false;
+            if (!job.user.empty()) {
+                it->second.user = job.user;
+                ostringstream overdue;
+                streambuf* original = cout.rdbuf(overdue.rdbuf());
+                listFor(job.user).checkOverdueTasks();
+                cout.rdbuf(original);
+                job.output += overdue.str();
+            }
+            appendResponse(it->second.output, job.output);
+            serveBuffered(job.fd, it->second, false);
+        }
+    }
+
+    // 'export <file> [--format F]' goes to a worker; anything else it cannot parse is left
+    // to the batch command, which reports the usage error.
+    bool startExport(int fd, Client& client, const vector<string>& words) {
+        bool withFormat = words.size() == 4 && words[2] == "--format";
+        if (words.size() != 2 && !withFormat) return false;
+        auto job = listFor(client.user).snapshotExport(words[1], withFormat ? words[3] : "");
+        if (job) {
+            startJob(fd, client, [job = move(job)](ostream& out) {
+                job(out);
+                return string();
+            });
+        }
+        return true;
+    }
+
+    // Password hashing is slow on purpose, so it runs on a worker like an export.
+    void startLogin(int fd, Client& client, const string& user, const string& password) {
+        startJob(fd, client, [user, password](ostream& out) {
+            return loginUser(user, password, out) ? trim(user) : string();
+        });
+    }
+
+    void runRequest(int fd, Client& client, vector<string> words) {
+        const string& command = words[0];
+        if ((command == "import" || command == "export") && words.size() > 1 && !client.user.empty() &&
+            !exchangePath(words[1], words[1])) {
+            cout << RED << "[ERROR] Files must be named relative to the server's " << EXCHANGE_DIR
+                 << " directory, without '..'." << RESET << endl;
+            return;
+        }
+        if (command == "quit") {
+            client.closing = true;
+        } else if (command == "login") {
+            if (!client.user.empty()) {
+                cout << RED << "[ERROR] Already logged in as " << client.user << "." << RESET << endl;
+            } else if (words.size() != 3) {
+                cout << RED << "[ERROR] usage: login <user> <password>" << RESET << endl;
+            } else {
+                startLogin(fd, client, words[1], words[2]);
+            }
+        } else if (client.user.empty()) {
+            cout << RED << "[ERROR] Log in first." << RESET << endl;
+        } else if (command == "logout") {
+            client.user.clear();
+            cout << GREEN << "[INFO] Logged out successfully." << RESET << endl;
+        } else if (command == "export" && startExport(fd, client, words)) {
+            return;
+        } else {
+            size_t changes = 0;
+            bool changing = command == "import" || command == "clear" || command == "remove-user";
+            ToDoList::SnapshotQuery query;
+            if (runBatchCommand(listFor(client.user), words, "", changes, &query) && (changes > 0 || changing)) {
+                noteChange(client.user, words);
+            }
+            if (query) {
+                startJob(fd, client, [query = move(query)](ostream& out) {
+                    query(out);
+                    return string();
+                });
+            }
+        }
+    }
+
+    static void appendResponse(string& out, const string& text) {
+        for (size_t start = 0; start < text.size();) {
+            size_t end = text.find('\n', start);
+            end = end == string::npos ? text.size() : end + 1;
+            if (text[start] == '.') out += '.';
+            out.append(text, start, end - start);
+            start = end;
+        }
+        if (!text.empty() && text.back() != '\n') out += '\n';
+        out += ".\n";
+    }
+
+    void handleLine(int fd, Client& client, const string& line) {
+        vector<string> words = splitCommandWords(line);
+        if (words.empty() || words[0][0] == '#') return;
+        ostringstream response;
+        streambuf* original = cout.rdbuf(response.rdbuf());
+        runRequest(fd, client, words);
+        cout.rdbuf(original);
+        if (!client.busy) appendResponse(client.output, response.str());
+    }
+
+    static bool backedUp(const Client& client) { return client.output.size() - client.sent >= MAX_PENDING_OUTPUT; }
+
+    void processInput(int fd, Client& client) {
+        size_t start = 0, end;
+        while (!client.closing && !client.busy && !backedUp(client) &&
+               (end = client.input.find('\n', start)) != string::npos) {
+            handleLine(fd, client, client.input.substr(start, end - start));
+            start = end + 1;
+        }
+        client.input.erase(0, start);
+        if (client.input.size() > MAX_REQUEST_BYTES) {
+            appendResponse(client.output, "[ERROR] Request too long.\n");
+            client.closing = true;
+        }
+    }
+
+    // Writes what the socket takes and updates the client's interest set. Returns false
+    // once the client has been closed.
+    bool flushClient(int fd, Client& client) {
+        while (client.sent < client.output.size()) {
+            ssize_t written = send(fd, client.output.data() + client.sent, client.output.size() - client.sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) continue;
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (written <= 0) {
+                closeClient(fd);
+                return false;
+            }
+            client.sent += written;
+        }
+        if (client.sent == client.output.size()) {
+            client.output.clear();
+            client.sent = 0;
+            if (client.closing && !client.busy) {
+                closeClient(fd);
+                return false;
+            }
+        }
+        if (client.closing && client.busy) {
+            // A hung-up peer would report EPOLLHUP on every wait until its job is done.
+            if (client.registered) epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            client.registered = false;
+            return true;
+        }
+        uint32_t events = (client.closing || client.busy || backedUp(client) ? 0u : uint32_t(EPOLLIN)) |
+                          (client.output.empty() ? 0u : uint32_t(EPOLLOUT));
+        if (!client.registered) {
+            watch(fd, events);
+            client.registered = true;
+        } else if (events != client.events) {
+            watch(fd, events, EPOLL_CTL_MOD);
+        }
+        client.events = events;
+        return true;
+    }
+
+    void closeClient(int fd) {
+        if (clients[fd].registered) epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        clients.erase(fd);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0 && errno == EINTR) continue;
+            if (fd < 0) return;  // drained, or out of descriptors until a client leaves
+            clients[fd].connection = nextConnection++;
+            clients[fd].events = EPOLLIN;
+            watch(fd, EPOLLIN);
+        }
+    }
+
+    void serviceClient(int fd, uint32_t events) {
+        auto it = clients.find(fd);
+        if (it == clients.end()) return;
+        Client& client = it->second;
+        if (events & EPOLLERR) {
+            closeClient(fd);
+            return;
+        }
+        bool peerClosed = false;
+        if (events & (EPOLLIN | EPOLLHUP)) {
+            char buffer[16384];
+            ssize_t received = read(fd, buffer, sizeof(buffer));
+            if (received > 0) client.input.append(buffer, received);
+            else peerClosed = received == 0 || (errno != EAGAIN && errno != EINTR);
+        }
+        // One read per wakeup keeps a chatty client from starving the others.
+        serveBuffered(fd, client, peerClosed);
+    }
+
+    // Answers the complete requests already buffered, for as long as the client keeps up.
+    void serveBuffered(int fd, Client& client, bool peerClosed) {
+        do {
+            processInput(fd, client);
+            if (peerClosed) client.closing = true;
+            if (!flushClient(fd, client)) return;
+        } while (!client.closing && !client.busy && !backedUp(client) && client.input.find('\n') != string::npos);
+    }
+
+public:
+    explicit TaskServer(const string& path) : socketPath(path) {}
+
+    ~TaskServer() {
+        {
+            lock_guard lock(queueMutex);
+            stopping = true;
+        }
+        jobQueued.notify_all();
+        for (thread& worker : workers) worker.join();
+        for (const auto& entry : clients) close(entry.first);
+        for (int fd : {listenFd, signalFd, epollFd, wakeFd}) {
+            if (fd >= 0) close(fd);
+        }
+        if (listenFd >= 0) unlink(socketPath.c_str());
+        lists.clear();  // flushes each list's journal
+    }
+
+    TaskServer(const TaskServer&) = delete;
+    TaskServer& operator=(const TaskServer&) = delete;
+
+    bool start() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            cout << RED << "[ERROR] Socket path is too long: " << socketPath << RESET << endl;
+            return false;
+        }
+        strcpy(address.sun_path, socketPath.c_str());
+
+        // A socket file that still accepts connections belongs to a running server.
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (live) {
+            cout << RED << "[ERROR] Another server is already listening on " << socketPath << RESET << endl;
+            return false;
+        }
+        unlink(socketPath.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) return fail("Cannot create socket");
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(listenFd);
+            listenFd = -1;
+            return fail("Cannot bind " + socketPath);
+        }
+        if (listen(listenFd, SOMAXCONN) < 0) return fail("Cannot listen on " + socketPath);
+
+        sigset_t stopSignals;
+        sigemptyset(&stopSignals);
+        sigaddset(&stopSignals, SIGINT);
+        sigaddset(&stopSignals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &stopSignals, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+        signalFd = signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (signalFd < 0 || epollFd < 0 || wakeFd < 0) return fail("Cannot set up the event loop");
+        watch(listenFd, EPOLLIN);
+        watch(signalFd, EPOLLIN);
+        watch(wakeFd, EPOLLIN);
+
+        error_code ec;
+        filesystem::create_directory(EXCHANGE_DIR, ec);
+        unsigned workerCount = max(2u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < workerCount; ++i) workers.emplace_back([this] { runJobs(); });
+        return true;
+    }
+
+    // Serves clients until SIGINT or SIGTERM.
+    void run() {
+        cout << GREEN << "[INFO] Serving on " << socketPath << "." << RESET << endl;
+        epoll_event events[64];
+        while (true) {
+            int ready = epoll_wait(epollFd, events, 64, -1);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready < 0) {
+                fail("epoll_wait");
+                return;
+            }
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == signalFd) {
+                    cout << GREEN << "[INFO] Shutting down." << RESET << endl;
+                    return;
+                }
+                if (fd == listenFd) acceptClients();
+                else if (fd == wakeFd) collectFinishedJobs();
+                else serviceClient(fd, events[i].events);
+            }
+        }
+    }
+};
+#endif
+
+int serveTasks(const string& socketPath) {
+#ifdef __linux__
+    TaskServer server(socketPath);
+    if (!server.start()) return 1;
+    server.run();
+    dumpSessionStats("server");
+    return 0;
+#else
+    cout << RED << "[ERROR] Server mode needs epoll and is only available on Linux." << RESET << endl;
+    return 2;
+#endif
+}
+
 void greeting() {
     cout << "\n" << CYAN << string(50, '=') << RESET << "\n";
     cout << CYAN << "|" << BOLD << setw(48) << left << " Welcome to the To-Do List App" << RESET << CYAN << "|" << RESET << "\n";
     cout << CYAN << string(50, '=') << RESET << "\n";
 }
 
-int main() {
+// Rewrites every tasks_<user>.txt in the working directory in the requested format.
+// Journals are format-independent and are left untouched.
+bool convertTaskFiles(const string& formatName) {
+    if (formatName != "text" && formatName != "binary") {
+        cout << RED << "[ERROR] Unknown snapshot format '" << formatName << "'. Use 'text' or 'binary'." << RESET << endl;
+        return false;
+    }
+    SnapshotFormat format = formatName == "binary" ? SnapshotFormat::Binary : SnapshotFormat::Text;
+
+    bool ok = true;
+    size_t converted = 0;
+    for (const auto& entry : filesystem::directory_iterator(".")) {
+        string fileName = entry.path().filename().string();
+        if (fileName.find("tasks_") != 0 || !fileName.ends_with(".txt")) continue;
+
+        FileLock lock(taskLockFileName(fileName), FileLock::Exclusive);
+        vector<Task> tasks;
+        bool read = readTaskSnapshot(fileName, fileName.substr(6, fileName.size() - 10), tasks);
+        TaskStore store;
+        store.reserve(tasks.size());
+        for (const Task& task : tasks) store.push_back(task);
+        if (!read || !writeTaskSnapshot(fileName, store, "", format)) {
+            cout << RED << "[ERROR] Failed to convert " << fileName << RESET << endl;
+            ok = false;
+            continue;
+        }
+        ++converted;
+    }
+    cout << GREEN << "[INFO] Converted " << converted << " task file(s) to " << formatName << " format." << RESET << endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && string(argv[1]) == "--convert") {
+        return convertTaskFiles(argv[2]) ? 0 : 1;
+    }
+    // --batch [--checkpoint N] [script]: run commands from a file, or stdin when omitted or "-".
+    if (argc >= 2 && string(argv[1]) == "--batch") {
+        int checkpointEvery = 0;
+        string scriptName = "-";
+        for (int i = 2; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--checkpoint" && i + 1 < argc && parseInt(argv[i + 1], checkpointEvery) && checkpointEvery >= 0) {
+                ++i;
+            } else if (i == argc - 1 && !arg.starts_with("--")) {
+                scriptName = arg;
+            } else {
+                cout << RED << "[ERROR] Usage: " << argv[0] << " --batch [--checkpoint N] [script]" << RESET << endl;
+                return 2;
+            }
+        }
+        if (scriptName == "-") return runBatch(cin, checkpointEvery) == 0 ? 0 : 1;
+        ifstream script(scriptName);
+        if (!script.is_open()) {
+            cout << RED << "[ERROR] Cannot open batch script: " << scriptName << RESET << endl;
+            return 2;
+        }
+        return runBatch(script, checkpointEvery) == 0 ? 0 : 1;
+    }
+
+    // --serve [socket]: keep task lists resident and answer clients on a Unix socket.
+    if (argc >= 2 && string(argv[1]) == "--serve") {
+        if (argc > 3) {
+            cout << RED << "[ERROR] Usage: " << argv[0] << " --serve [socket]" << RESET << endl;
+            return 2;
+        }
+        return serveTasks(argc == 3 ? argv[2] : "todo.sock");
+    }
+
     greeting();
     showAuthMenu();
     return 0;
 }
-
-string simpleHash(const string& input) {
-    return input;
-}
\ No newline at end of file
@@ -0,0 +1,3674 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <filesystem>
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <unordered_map>
+#include <set>
+#include <map>
+#include <bit>
+#include <iterator>
+#include <atomic>
+#include <thread>
+#include <array>
+#include <random>
+#include <system_error>
+#include <deque>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <string_view>
+#include <memory>
+#include <numeric>
+#include <charconv>
+#include <chrono>
+#include <tuple>
+#include <utility>
+#include <functional>
+#include <optional>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+#ifdef __linux__
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+
+// reg add HKEY_CURRENT_USER\Console /v VirtualTerminalLevel /t REG_DWORD /d 1
+// ANSI color codes for styling
+#define RESET "\033[0m"
+#define RED "\033[31m"
+#define GREEN "\033[32m"
+#define YELLOW "\033[33m"
+#define BLUE "\033[34m"
+#define CYAN "\033[36m"
+#define BOLD "\033[1m"
+
+struct Date {
+    int day, month, year;
+
+    constexpr Date(int d = 1, int m = 1, int y = 1970) : day(d), month(m), year(y) {}
+
+    static Date fromString(const std::string& dateStr) {
+        if (dateStr.size() != 10 || dateStr[2] != '-' || dateStr[5] != '-') {
+            return Date(0, 0, 0); // Invalid date
+        }
+
+        int fields[3] = {0, 0, 0};
+        const size_t starts[3] = {0, 3, 6}, lengths[3] = {2, 2, 4};
+        for (int f = 0; f < 3; ++f) {
+            for (size_t i = starts[f]; i < starts[f] + lengths[f]; ++i) {
+                if (dateStr[i] < '0' || dateStr[i] > '9') return Date(0, 0, 0); // Invalid date
+                fields[f] = fields[f] * 10 + (dateStr[i] - '0');
+            }
+        }
+        return Date(fields[0], fields[1], fields[2]);
+    }
+
+    constexpr bool isValid() const {
+        if (month < 1 || month > 12 || day < 1 || year < 1970 || year > 9999) {
+            return false;
+        }
+
+        int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        if (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+            daysInMonth[1] = 29;
+        }
+        return day <= daysInMonth[month - 1];
+    }
+
+    // Day number counted from 01-01-1970 (proleptic Gregorian, Hinnant's days_from_civil).
+    // Tasks store this form, so ordering and overdue checks are plain integer compares.
+    constexpr int toDays() const {
+        int y = year - (month <= 2 ? 1 : 0);
+        int era = (y >= 0 ? y : y - 399) / 400;
+        int yearOfEra = y - era * 400;
+        int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    static constexpr Date fromDays(int days) {
+        days += 719468;
+        int era = (days >= 0 ? days : days - 146096) / 146097;
+        int dayOfEra = days - era * 146097;
+        int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int shiftedMonth = (5 * dayOfYear + 2) / 153;
+        int d = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        int m = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        return Date(d, m, yearOfEra + era * 400 + (m <= 2 ? 1 : 0));
+    }
+
+    // Local-time day number of today. Take it once per operation and compare against it.
+    static int today() {
+        time_t now = time(nullptr);
+        tm* current = localtime(&now);
+        return Date(current->tm_mday, current->tm_mon + 1, current->tm_year + 1900).toDays();
+    }
+
+    std::string toString() const {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%02d-%02d-%04d", day, month, year);
+        return buffer;
+    }
+};
+
+static_assert(Date(1, 1, 1970).toDays() == 0);
+static_assert(Date(29, 2, 2000).toDays() == 11016);
+static_assert(Date::fromDays(Date(31, 12, 9999).toDays()).day == 31);
+
+inline std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(" \t\n\r");
+    size_t last = str.find_last_not_of(" \t\n\r");
+    if (first == std::string::npos || last == std::string::npos) return "";
+    return str.substr(first, last - first + 1);
+}
+
+inline bool parseInt(const std::string& input, int& result) {
+    try {
+        size_t pos;
+        result = std::stoi(input, &pos);
+        if (pos != input.size()) return false;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+inline bool isValidDueDate(const std::string& dueDate) {
+    Date date = Date::fromString(dueDate);
+    return date.isValid();
+}
+
+inline bool isValidPriority(int priority) {
+    return priority >= 1 && priority <= 5;
+}
+
+// Latency histogram with HDR-style log-linear buckets: values below 32 ns get exact
+// buckets, larger ones 16 buckets per power of two (about 6% precision). Every field is
+// a relaxed atomic, so recording from loader threads needs no lock.
+class LatencyHistogram {
+private:
+    static constexpr size_t BUCKETS = 61 * 16;
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> total{0}, sum{0}, maximum{0};
+
+    static size_t bucketOf(uint64_t nanos) {
+        int shift = std::max(0, static_cast<int>(std::bit_width(nanos)) - 5);
+        return static_cast<size_t>(shift) * 16 + static_cast<size_t>(nanos >> shift);
+    }
+
+    static uint64_t bucketFloor(size_t bucket) {
+        if (bucket < 32) return bucket;
+        size_t shift = bucket / 16 - 1;
+        return static_cast<uint64_t>(bucket - shift * 16) << shift;
+    }
+
+public:
+    void record(uint64_t nanos) {
+        buckets[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t seen = maximum.load(std::memory_order_relaxed);
+        while (nanos > seen && !maximum.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t maxValue() const { return maximum.load(std::memory_order_relaxed); }
+    uint64_t mean() const { return count() ? sum.load(std::memory_order_relaxed) / count() : 0; }
+
+    // Lower bound of the bucket holding the given quantile (0..1).
+    uint64_t percentile(double quantile) const {
+        uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count()));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+            seen += buckets[bucket].load(std::memory_order_relaxed);
+            if (seen > rank) return bucketFloor(bucket);
+        }
+        return maxValue();
+    }
+};
+
+// Where time and I/O go, process-wide: one histogram per timed operation plus byte and
+// task counters. Shown from the admin menu and appended to TODO_STATS_FILE on logout.
+class Metrics {
+public:
+    enum Operation {
+        LoadUser, LoadAllUsers, SaveSnapshot, JournalWrite, AddTask, EditTask, MarkDone,
+        UnmarkDone, DeleteTask, SortTasks, Search, Render, Import, Export, OPERATION_COUNT
+    };
+
+    std::atomic<uint64_t> bytesRead{0}, bytesWritten{0}, tasksLoaded{0}, tasksSaved{0};
+
+    static Metrics& instance() {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    LatencyHistogram& histogram(Operation operation) { return histograms[operation]; }
+
+    void report(std::ostream& out) const {
+        static const char* const names[OPERATION_COUNT] = {
+            "load user", "load all users", "save snapshot", "journal write", "add task", "edit task",
+            "mark done", "unmark done", "delete task", "sort", "search", "render", "import", "export"};
+        auto micros = [](uint64_t nanos) { return static_cast<double>(nanos) / 1000.0; };
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+
+        out << std::left << std::setw(16) << "operation" << std::right << std::setw(9) << "count" << std::setw(12) << "mean us"
+            << std::setw(12) << "p50 us" << std::setw(12) << "p90 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us" << "\n";
+        out << std::fixed << std::setprecision(1);
+        for (int op = 0; op < OPERATION_COUNT; ++op) {
+            const LatencyHistogram& h = histograms[op];
+            if (h.count() == 0) continue;
+            out << std::left << std::setw(16) << names[op] << std::right << std::setw(9) << h.count() << std::setw(12) << micros(h.mean())
+                << std::setw(12) << micros(h.percentile(0.5)) << std::setw(12) << micros(h.percentile(0.9))
+                << std::setw(12) << micros(h.percentile(0.99)) << std::setw(12) << micros(h.maxValue()) << "\n";
+        }
+        out << "bytes read: " << bytesRead.load() << ", bytes written: " << bytesWritten.load()
+            << ", tasks loaded: " << tasksLoaded.load() << ", tasks saved: " << tasksSaved.load() << "\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    std::array<LatencyHistogram, OPERATION_COUNT> histograms;
+};
+
+// Records the lifetime of the enclosing scope into one operation's histogram.
+class MetricTimer {
+private:
+    Metrics::Operation operation;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit MetricTimer(Metrics::Operation timed) : operation(timed), start(std::chrono::steady_clock::now()) {}
+
+    ~MetricTimer() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        Metrics::instance().histogram(operation).record(static_cast<uint64_t>(elapsed.count()));
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+};
+
+// Process-wide interning for strings that repeat across many tasks (category, owner).
+// Tasks store the returned ids, so filters compare integers and each distinct string is
+// kept once. Strings live in a deque, so references handed out by name() stay valid.
+class SymbolTable {
+private:
+    struct ViewHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+    };
+
+    mutable std::shared_mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, uint32_t, ViewHash, std::equal_to<>> ids;
+
+public:
+    static SymbolTable& instance() {
+        static SymbolTable table;
+        return table;
+    }
+
+    uint32_t intern(std::string_view text) {
+        {
+            std::shared_lock lock(mutex);
+            auto it = ids.find(text);
+            if (it != ids.end()) return it->second;
+        }
+        std::unique_lock lock(mutex);
+        auto it = ids.find(text);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.emplace_back(text);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    // Looks up an existing symbol without creating one.
+    bool find(std::string_view text, uint32_t& id) const {
+        std::shared_lock lock(mutex);
+        auto it = ids.find(text);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    const std::string& name(uint32_t id) const {
+        std::shared_lock lock(mutex);
+        return names[id];
+    }
+};
+
+inline uint32_t internSymbol(std::string_view text) { return SymbolTable::instance().intern(text); }
+inline const std::string& symbolName(uint32_t id) { return SymbolTable::instance().name(id); }
+
+struct Task {
+    int id;
+    std::string name;
+    int priority;
+    int dueDay;  // see Date::toDays
+    bool done;
+    uint32_t categoryId;  // SymbolTable ids
+    uint32_t ownerId;
+    bool deleted = false;  // tombstone left by ToDoList until the next compaction
+
+    Task(int _id, const std::string& _name, int _priority, int _dueDay, bool _done = false,
+         const std::string& _category = "General", const std::string& _owner = "")
+        : id(_id), name(_name), priority(_priority), dueDay(_dueDay), done(_done),
+          categoryId(internSymbol(_category)), ownerId(internSymbol(_owner)) {}
+
+    Task(int _id, std::string _name, int _priority, int _dueDay, bool _done, uint32_t _categoryId, uint32_t _ownerId)
+        : id(_id), name(std::move(_name)), priority(_priority), dueDay(_dueDay), done(_done),
+          categoryId(_categoryId), ownerId(_ownerId) {}
+
+    const std::string& category() const { return symbolName(categoryId); }
+    const std::string& owner() const { return symbolName(ownerId); }
+
+    std::string dueDateString() const { return Date::fromDays(dueDay).toString(); }
+    bool isOverdue(int today) const { return !done && dueDay < today; }
+};
+
+// Column-oriented task storage used by ToDoList: one contiguous array per field, so a scan
+// over priorities, due days or flags touches only that column. Task names live back to back
+// in a shared arena addressed by offset/length; category and owner are already symbol ids.
+// Rows are addressed by slot. Renaming leaves the old bytes behind as garbage, which is
+// reclaimed once it outweighs the live bytes; compact() drops deleted rows.
+class TaskStore {
+private:
+    static constexpr uint8_t DONE = 1, DELETED = 2;
+    static constexpr size_t MIN_ARENA_GARBAGE = 1 << 16;
+
+    std::vector<int> ids, priorities, dueDays;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> categoryIds, ownerIds;
+    std::vector<uint32_t> nameOffsets, nameLengths;
+    std::string arena;
+    size_t arenaGarbage = 0;
+
+    uint32_t appendName(std::string_view name) {
+        uint32_t offset = static_cast<uint32_t>(arena.size());
+        arena.append(name);
+        return offset;
+    }
+
+    // Rebuilds every column from the rows listed in `order`, repacking names in that order.
+    void gather(const std::vector<size_t>& order) {
+        auto pick = [&order](auto& column) {
+            std::remove_reference_t<decltype(column)> picked;
+            picked.reserve(order.size());
+            for (size_t slot : order) picked.push_back(column[slot]);
+            column.swap(picked);
+        };
+        std::string packed;
+        std::vector<uint32_t> offsets;
+        offsets.reserve(order.size());
+        for (size_t slot : order) {
+            offsets.push_back(static_cast<uint32_t>(packed.size()));
+            packed.append(arena, nameOffsets[slot], nameLengths[slot]);
+        }
+        pick(ids);
+        pick(priorities);
+        pick(dueDays);
+        pick(flags);
+        pick(categoryIds);
+        pick(ownerIds);
+        pick(nameLengths);
+        nameOffsets.swap(offsets);
+        arena.swap(packed);
+        arenaGarbage = 0;
+    }
+
+public:
+    size_t size() const { return ids.size(); }
+
+    void reserve(size_t rows) {
+        ids.reserve(rows);
+        priorities.reserve(rows);
+        dueDays.reserve(rows);
+        flags.reserve(rows);
+        categoryIds.reserve(rows);
+        ownerIds.reserve(rows);
+        nameOffsets.reserve(rows);
+        nameLengths.reserve(rows);
+    }
+
+    void clear() {
+        ids.clear();
+        priorities.clear();
+        dueDays.clear();
+        flags.clear();
+        categoryIds.clear();
+        ownerIds.clear();
+        nameOffsets.clear();
+        nameLengths.clear();
+        arena.clear();
+        arenaGarbage = 0;
+    }
+
+    // Appends a row and returns its slot.
+    size_t push_back(const Task& task) {
+        ids.push_back(task.id);
+        priorities.push_back(task.priority);
+        dueDays.push_back(task.dueDay);
+        flags.push_back((task.done ? DONE : 0) | (task.deleted ? DELETED : 0));
+        categoryIds.push_back(task.categoryId);
+        ownerIds.push_back(task.ownerId);
+        nameOffsets.push_back(appendName(task.name));
+        nameLengths.push_back(static_cast<uint32_t>(task.name.size()));
+        return ids.size() - 1;
+    }
+
+    // Materialises a row, for callers that need a whole task (journal records, snapshots).
+    Task get(size_t slot) const {
+        Task task(ids[slot], std::string(name(slot)), priorities[slot], dueDays[slot], done(slot),
+                  categoryIds[slot], ownerIds[slot]);
+        task.deleted = deleted(slot);
+        return task;
+    }
+
+    int id(size_t slot) const { return ids[slot]; }
+    int priority(size_t slot) const { return priorities[slot]; }
+    int dueDay(size_t slot) const { return dueDays[slot]; }
+    bool done(size_t slot) const { return flags[slot] & DONE; }
+    bool deleted(size_t slot) const { return flags[slot] & DELETED; }
+    uint32_t categoryId(size_t slot) const { return categoryIds[slot]; }
+    uint32_t ownerId(size_t slot) const { return ownerIds[slot]; }
+    std::string_view name(size_t slot) const { return std::string_view(arena).substr(nameOffsets[slot], nameLengths[slot]); }
+    const std::string& category(size_t slot) const { return symbolName(categoryIds[slot]); }
+    const std::string& owner(size_t slot) const { return symbolName(ownerIds[slot]); }
+    std::string dueDateString(size_t slot) const { return Date::fromDays(dueDays[slot]).toString(); }
+
+    void setPriority(size_t slot, int priority) { priorities[slot] = priority; }
+    void setDueDay(size_t slot, int dueDay) { dueDays[slot] = dueDay; }
+    void setCategoryId(size_t slot, uint32_t categoryId) { categoryIds[slot] = categoryId; }
+    void setDeleted(size_t slot) { flags[slot] |= DELETED; }
+
+    void setDone(size_t slot, bool done) {
+        if (done) flags[slot] |= DONE;
+        else flags[slot] &= ~DONE;
+    }
+
+    void setName(size_t slot, std::string_view name) {
+        arenaGarbage += nameLengths[slot];
+        nameOffsets[slot] = appendName(name);
+        nameLengths[slot] = static_cast<uint32_t>(name.size());
+        if (arenaGarbage >= MIN_ARENA_GARBAGE && arenaGarbage * 2 >= arena.size()) {
+            std::vector<size_t> order(size());
+            std::iota(order.begin(), order.end(), 0);
+            gather(order);
+        }
+    }
+
+    // Drops deleted rows; surviving rows keep their relative order.
+    void compact() {
+        std::vector<size_t> order;
+        order.reserve(size());
+        for (size_t slot = 0; slot < size(); ++slot) {
+            if (!deleted(slot)) order.push_back(slot);
+        }
+        gather(order);
+    }
+};
+
+// A row of a TaskStore: the store and the row's index in it.
+using TaskRow = std::pair<const TaskStore&, size_t>;
+
+// An immutable copy of a task store at one version. Rows sit in fixed-size chunks that
+// consecutive versions share, so publishing a version copies only the chunks a writer
+// touched. Any number of threads may read a snapshot while its list keeps changing.
+class TaskSnapshot {
+public:
+    static constexpr size_t CHUNK_ROWS = 1024;
+    using Chunk = std::shared_ptr<const TaskStore>;
+
+    TaskSnapshot(uint64_t snapshotVersion, std::vector<Chunk> rowChunks)
+        : snapshotVersion(snapshotVersion), chunks(std::move(rowChunks)) {}
+
+    uint64_t version() const { return snapshotVersion; }
+
+    // Calls visit(store, row) for every live row, in slot order, optionally for one owner only.
+    template <typename Visit>
+    void forEachLive(std::optional<uint32_t> ownerId, Visit visit) const {
+        forEachLiveSlot(ownerId, [&visit](const TaskStore& rows, size_t row, size_t) { visit(rows, row); });
+    }
+
+    // Like forEachLive(), also passing each row's slot in the list the snapshot was taken from.
+    template <typename Visit>
+    void forEachLiveSlot(std::optional<uint32_t> ownerId, Visit visit) const {
+        for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+            const TaskStore& rows = *chunks[chunk];
+            for (size_t row = 0; row < rows.size(); ++row) {
+                if (!rows.deleted(row) && (!ownerId || rows.ownerId(row) == *ownerId)) visit(rows, row, chunk * CHUNK_ROWS + row);
+            }
+        }
+    }
+
+    TaskRow at(size_t slot) const { return {*chunks[slot / CHUNK_ROWS], slot % CHUNK_ROWS}; }
+
+private:
+    uint64_t snapshotVersion;
+    std::vector<Chunk> chunks;
+};
+
+inline std::string escapeJson(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\b': escaped += "\\b"; break;
+            case '\f': escaped += "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static constexpr char HEX[] = "0123456789abcdef";
+                    escaped += "\\u00";
+                    escaped += HEX[c >> 4];
+                    escaped += HEX[c & 0xF];
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// Text snapshots are wrapped as {"format":2,"tasks":[...]} and escape their strings.
+// Files from before escaping are a bare array whose strings hold raw characters, so a
+// name like "C:\temp" must be read back as written.
+constexpr int TEXT_SNAPSHOT_VERSION = 2;
+
+// Single-pass reader for the task file format (a JSON array of flat task objects).
+// Input is pulled through a fixed buffer and each value is decoded straight into the
+// matching Task field, so loading is linear in the file size with no intermediate copies.
+class TaskFileParser {
+private:
+    std::istream& in;
+    char buffer[1 << 16];
+    size_t pos = 0, len = 0;
+    std::string key;
+    bool requireId;
+    bool decodeEscapes;
+    bool started = false;
+
+    int peek() {
+        if (pos == len) {
+            in.read(buffer, sizeof(buffer));
+            len = static_cast<size_t>(in.gcount());
+            pos = 0;
+            if (len == 0) return EOF;
+        }
+        return static_cast<unsigned char>(buffer[pos]);
+    }
+
+    int get() {
+        int c = peek();
+        if (c != EOF) ++pos;
+        return c;
+    }
+
+    int skipWhitespace() {
+        int c = peek();
+        while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++pos;
+            c = peek();
+        }
+        return c;
+    }
+
+    bool readHex4(uint32_t& out) {
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            int c = get();
+            int digit = c >= '0' && c <= '9' ? c - '0'
+                      : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                      : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0) return false;
+            out = out << 4 | uint32_t(digit);
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | code >> 6);
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | code >> 12);
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | code >> 18);
+            out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // The code point of a \uXXXX escape (backslash and 'u' already consumed), joining a
+    // UTF-16 surrogate pair; an unpaired surrogate becomes U+FFFD.
+    bool readUnicodeEscape(uint32_t& code) {
+        if (!readHex4(code)) return false;
+        if (code < 0xD800 || code > 0xDFFF) return true;
+        if (code > 0xDBFF || peek() != '\\') {
+            code = 0xFFFD;
+            return true;
+        }
+        ++pos;
+        uint32_t low;
+        if (get() != 'u' || !readHex4(low)) return false;
+        if (low < 0xDC00 || low > 0xDFFF) {
+            code = 0xFFFD;  // and the second escape is lost with it
+            return true;
+        }
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        return true;
+    }
+
+    // Reads a quoted string (opening quote already consumed), decoding escapes unless
+    // the file predates them.
+    bool readString(std::string& out) {
+        out.clear();
+        while (true) {
+            int c = get();
+            if (c == EOF) return false;
+            if (c == '"') return true;
+            if (c == '\\' && decodeEscapes) {
+                c = get();
+                uint32_t code;
+                switch (c) {
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u':
+                        if (!readUnicodeEscape(code)) return false;
+                        appendUtf8(out, code);
+                        break;
+                    case EOF: return false;
+                    default: out += static_cast<char>(c);  // \" \\ \/
+                }
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+
+    bool readInt(int& out) {
+        bool negative = false;
+        if (peek() == '-') {
+            negative = true;
+            ++pos;
+        }
+        int c = peek();
+        if (c < '0' || c > '9') return false;
+        long long value = 0;
+        while (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            if (value > std::numeric_limits<int>::max()) return false;
+            ++pos;
+            c = peek();
+        }
+        out = static_cast<int>(negative ? -value : value);
+        return true;
+    }
+
+    bool readLiteral(const char* literal) {
+        for (const char* p = literal; *p; ++p) {
+            if (get() != *p) return false;
+        }
+        return true;
+    }
+
+    // Skips an unknown value, stepping over strings and nested arrays or objects.
+    bool skipValue() {
+        int depth = 0;
+        for (int c = peek(); c != EOF; c = peek()) {
+            if (c == '"') {
+                ++pos;
+                if (!readString(key)) return false;
+                continue;
+            }
+            if (depth == 0 && (c == ',' || c == '}')) return true;
+            if (c == '[' || c == '{') ++depth;
+            else if ((c == ']' || c == '}') && --depth < 0) return false;
+            ++pos;
+        }
+        return false;
+    }
+
+    // Resynchronises after a malformed object by skipping to its closing brace,
+    // stepping over quoted strings so braces inside names are not mistaken for it.
+    void skipObject() {
+        int c;
+        while ((c = get()) != EOF && c != '}') {
+            if (c == '"') readString(key);
+        }
+    }
+
+    bool readField(Task& task, bool& hasId) {
+        if (get() != '"' || !readString(key)) return false;
+        if (skipWhitespace() != ':') return false;
+        ++pos;
+        int c = skipWhitespace();
+
+        if (key == "id") return hasId = readInt(task.id);
+        if (key == "priority") return readInt(task.priority);
+        if (key == "done") {
+            task.done = (c == 't');
+            return readLiteral(task.done ? "true" : "false");
+        }
+        if (c != '"') return skipValue();
+        ++pos;
+        if (key == "name") return readString(task.name);
+        if (key == "dueDate") {
+            if (!readString(key)) return false;
+            Date date = Date::fromString(key);
+            task.dueDay = date.toDays();
+            return date.isValid();
+        }
+        if (key == "category" || key == "owner") {
+            bool isCategory = key == "category";
+            if (!readString(key)) return false;
+            if (!key.empty()) (isCategory ? task.categoryId : task.ownerId) = internSymbol(key);
+            return true;
+        }
+        return readString(key);
+    }
+
+    // Reads the {"format":N,"tasks": prefix of a versioned snapshot up to its array.
+    bool readHeader() {
+        ++pos;
+        int version = 0;
+        while (true) {
+            int c = skipWhitespace();
+            if (c == ',') {
+                ++pos;
+                continue;
+            }
+            if (c != '"' || (++pos, !readString(key)) || skipWhitespace() != ':') return false;
+            ++pos;
+            skipWhitespace();
+            if (key == "tasks") break;
+            if (key == "format" ? !readInt(version) : !skipValue()) return false;
+        }
+        decodeEscapes = version >= 2;
+        return true;
+    }
+
+public:
+    // Imports are ordinary JSON and assign fresh ids; snapshots say whether they escape.
+    explicit TaskFileParser(std::istream& input, bool importing = false)
+        : in(input), requireId(!importing), decodeEscapes(importing) {}
+
+    // Reads the next task object into `task`. Returns false once the input is exhausted;
+    // `valid` is cleared when the object was malformed and has been skipped. Fields that
+    // are absent keep the values `task` had on entry.
+    bool next(Task& task, bool& valid) {
+        int c = skipWhitespace();
+        if (!started) {
+            started = true;
+            if (requireId && c == '{' && !readHeader()) return false;
+            c = skipWhitespace();
+        }
+        while (c == '[' || c == ',') {
+            ++pos;
+            c = skipWhitespace();
+        }
+        if (c != '{') return false;
+        ++pos;
+
+        valid = false;
+        bool hasId = false;
+        while (true) {
+            c = skipWhitespace();
+            if (c == '}') {
+                ++pos;
+                valid = hasId || !requireId;
+                return true;
+            }
+            if (c == ',') {
+                ++pos;
+                continue;
+            }
+            if (c != '"' || !readField(task, hasId)) {
+                skipObject();
+                return true;
+            }
+        }
+    }
+};
+
+// Task files come in two on-disk formats sharing the tasks_<user>.txt name: the JSON-style
+// text array above and a binary snapshot that is mapped into memory and read in place.
+// The format written is chosen per deployment through TODO_SNAPSHOT_FORMAT=text|binary;
+// readers detect the format from the file's leading magic bytes.
+enum class SnapshotFormat { Text, Binary };
+
+inline SnapshotFormat configuredSnapshotFormat() {
+    static const SnapshotFormat format = [] {
+        const char* value = getenv("TODO_SNAPSHOT_FORMAT");
+        return value && std::string(value) == "binary" ? SnapshotFormat::Binary : SnapshotFormat::Text;
+    }();
+    return format;
+}
+
+constexpr char BINARY_SNAPSHOT_MAGIC[8] = {'T', 'O', 'D', 'O', 'B', 'I', 'N', '\0'};
+constexpr uint32_t BINARY_SNAPSHOT_VERSION = 2;
+
+// Layout (native byte order): header, taskCount fixed-size records, then a string heap
+// that records reference by offset/length. Category and owner strings are stored once.
+struct BinarySnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t taskCount;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+};
+
+struct BinaryTaskRecord {
+    int32_t id;
+    int32_t dueDay;  // Date::toDays(); version 1 stored (year << 9) | (month << 5) | day
+    uint8_t priority;
+    uint8_t done;
+    uint16_t reserved;
+    uint32_t nameOffset, nameLength;
+    uint32_t categoryOffset, categoryLength;
+    uint32_t ownerOffset, ownerLength;
+};
+
+static_assert(sizeof(BinarySnapshotHeader) == 32, "binary snapshot header layout changed");
+static_assert(sizeof(BinaryTaskRecord) == 36, "binary snapshot record layout changed");
+
+// Read-only view of a whole file: mmap where available, a plain read elsewhere.
+class MappedFile {
+private:
+    const char* mapped = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    std::vector<char> contents;
+#endif
+
+public:
+    explicit MappedFile(const std::string& fileName) {
+#ifdef _WIN32
+        std::ifstream inFile(fileName, std::ios::binary);
+        if (!inFile.is_open()) return;
+        contents.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+        mapped = contents.data();
+        length = contents.size();
+        opened = true;
+#else
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            length = static_cast<size_t>(info.st_size);
+            if (length == 0) {
+                opened = true;
+            } else {
+                void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address != MAP_FAILED) {
+                    mapped = static_cast<const char*>(address);
+                    opened = true;
+                }
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapped) munmap(const_cast<char*>(mapped), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return mapped; }
+    size_t size() const { return length; }
+};
+
+// One task as a flat JSON object, the record layout shared by text snapshots and JSON Lines.
+inline void writeTaskJson(std::ostream& out, const TaskStore& tasks, size_t slot) {
+    out << "{";
+    out << "\"id\":" << tasks.id(slot) << ",";
+    out << "\"name\":\"" << escapeJson(tasks.name(slot)) << "\",";
+    out << "\"priority\":" << tasks.priority(slot) << ",";
+    out << "\"dueDate\":\"" << tasks.dueDateString(slot) << "\",";
+    out << "\"done\":" << (tasks.done(slot) ? "true" : "false") << ",";
+    out << "\"category\":\"" << escapeJson(tasks.category(slot)) << "\",";
+    out << "\"owner\":\"" << escapeJson(tasks.owner(slot)) << "\"";
+    out << "}";
+}
+
+// Writes the snapshot body for the rows forEachRow(visit) passes to visit(store, row).
+template <typename ForEachRow>
+void writeSnapshotRows(std::ofstream& outFile, ForEachRow forEachRow, SnapshotFormat format) {
+    if (format == SnapshotFormat::Text) {
+        outFile << "{\"format\":" << TEXT_SNAPSHOT_VERSION << ",\"tasks\":[\n";
+        bool first = true;
+        forEachRow([&](const TaskStore& tasks, size_t slot) {
+            outFile << (first ? "" : ",\n") << "  ";
+            first = false;
+            writeTaskJson(outFile, tasks, slot);
+            ++Metrics::instance().tasksSaved;
+        });
+        outFile << (first ? "" : "\n") << "]}\n";
+        Metrics::instance().bytesWritten += static_cast<uint64_t>(outFile.tellp());
+        return;
+    }
+
+    std::vector<BinaryTaskRecord> records;
+    std::string heap;
+    std::unordered_map<uint32_t, uint32_t> sharedStrings;  // symbol id -> heap offset
+    auto addString = [&heap](std::string_view str) {
+        uint32_t offset = static_cast<uint32_t>(heap.size());
+        heap += str;
+        return offset;
+    };
+    auto addShared = [&](uint32_t symbol) {
+        auto it = sharedStrings.find(symbol);
+        if (it != sharedStrings.end()) return it->second;
+        uint32_t offset = addString(symbolName(symbol));
+        sharedStrings.emplace(symbol, offset);
+        return offset;
+    };
+
+    forEachRow([&](const TaskStore& tasks, size_t slot) {
+        BinaryTaskRecord record{};
+        record.id = tasks.id(slot);
+        record.dueDay = tasks.dueDay(slot);
+        record.priority = static_cast<uint8_t>(tasks.priority(slot));
+        record.done = tasks.done(slot) ? 1 : 0;
+        record.nameOffset = addString(tasks.name(slot));
+        record.nameLength = static_cast<uint32_t>(tasks.name(slot).size());
+        record.categoryOffset = addShared(tasks.categoryId(slot));
+        record.categoryLength = static_cast<uint32_t>(tasks.category(slot).size());
+        record.ownerOffset = addShared(tasks.ownerId(slot));
+        record.ownerLength = static_cast<uint32_t>(tasks.owner(slot).size());
+        records.push_back(record);
+    });
+
+    BinarySnapshotHeader header{};
+    memcpy(header.magic, BINARY_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = BINARY_SNAPSHOT_VERSION;
+    header.taskCount = static_cast<uint32_t>(records.size());
+    header.heapOffset = sizeof(header) + records.size() * sizeof(BinaryTaskRecord);
+    header.heapSize = heap.size();
+
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(BinaryTaskRecord));
+    outFile.write(heap.data(), heap.size());
+    Metrics::instance().bytesWritten += header.heapOffset + heap.size();
+    Metrics::instance().tasksSaved += records.size();
+}
+
+template <typename ForEachRow>
+bool writeSnapshotFile(const std::string& fileName, ForEachRow forEachRow, SnapshotFormat format, std::ostream& log) {
+    std::ofstream outFile(fileName, std::ios::binary | std::ios::trunc);
+    if (!outFile.is_open()) {
+        log << RED << "[ERROR] Cannot open file for writing: " << fileName << RESET << std::endl;
+        return false;
+    }
+    writeSnapshotRows(outFile, forEachRow, format);
+    outFile.close();
+    if (!outFile.fail()) return true;
+    log << RED << "[ERROR] Failed to write " << fileName << RESET << std::endl;
+    return false;
+}
+
+// Writes to "<fileName>.tmp" and renames it into place, so a reader or a crash never sees
+// a half-written snapshot.
+template <typename ForEachRow>
+bool replaceSnapshotFile(const std::string& fileName, ForEachRow forEachRow, SnapshotFormat format, std::ostream& log) {
+    std::string tempName = fileName + ".tmp";
+    std::error_code ec;
+    if (writeSnapshotFile(tempName, forEachRow, format, log)) {
+        std::filesystem::rename(tempName, fileName, ec);
+        if (!ec) return true;
+        log << RED << "[ERROR] Cannot replace " << fileName << ": " << ec.message() << RESET << std::endl;
+    }
+    std::filesystem::remove(tempName, ec);
+    return false;
+}
+
+// Writes the rows listed in `slots`, in that order.
+inline bool writeTaskSnapshot(const std::string& fileName, const TaskStore& tasks, const std::vector<size_t>& slots,
+                       SnapshotFormat format) {
+    auto forEachRow = [&](auto visit) {
+        for (size_t slot : slots) visit(tasks, slot);
+    };
+    return replaceSnapshotFile(fileName, forEachRow, format, std::cout);
+}
+
+// Writes every live row of a published snapshot, or only those of `ownerId` when given,
+// straight to `fileName`; the caller moves the file into place.
+inline bool writeTaskSnapshot(const std::string& fileName, const TaskSnapshot& snapshot, std::optional<uint32_t> ownerId,
+                       SnapshotFormat format, std::ostream& log) {
+    auto forEachRow = [&](auto visit) { snapshot.forEachLive(ownerId, visit); };
+    return writeSnapshotFile(fileName, forEachRow, format, log);
+}
+
+// Writes every live task, or only those of `owner` when one is given.
+inline bool writeTaskSnapshot(const std::string& fileName, const TaskStore& tasks, const std::string& owner,
+                       SnapshotFormat format) {
+    uint32_t ownerId = 0;
+    bool filtered = !owner.empty();
+    bool ownerKnown = filtered && SymbolTable::instance().find(owner, ownerId);
+    std::vector<size_t> slots;
+    for (size_t slot = 0; slot < tasks.size(); ++slot) {
+        if (!tasks.deleted(slot) && (!filtered || (ownerKnown && tasks.ownerId(slot) == ownerId))) {
+            slots.push_back(slot);
+        }
+    }
+    return writeTaskSnapshot(fileName, tasks, slots, format);
+}
+
+inline bool readBinarySnapshot(const std::string& fileName, const std::string& owner, std::vector<Task>& out, std::ostream& log) {
+    MappedFile file(fileName);
+    if (!file.isOpen()) return false;
+
+    BinarySnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        log << YELLOW << "[WARNING] Truncated binary snapshot: " << fileName << RESET << std::endl;
+        return true;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    // Checked as differences, so corrupt 64-bit fields cannot wrap around.
+    uint64_t recordsEnd = sizeof(header) + static_cast<uint64_t>(header.taskCount) * sizeof(BinaryTaskRecord);
+    if ((header.version != 1 && header.version != BINARY_SNAPSHOT_VERSION) || recordsEnd > file.size() ||
+        header.heapOffset != recordsEnd || header.heapSize > file.size() - header.heapOffset) {
+        log << YELLOW << "[WARNING] Unsupported or corrupt binary snapshot: " << fileName << RESET << std::endl;
+        return true;
+    }
+
+    const char* heap = file.data() + header.heapOffset;
+    auto inHeap = [&header](uint32_t offset, uint32_t size) {
+        return offset <= header.heapSize && size <= header.heapSize - offset;
+    };
+
+    // Shared strings are stored once in the heap, so intern each heap offset only once.
+    std::unordered_map<uint32_t, uint32_t> symbolsByOffset;
+    auto symbolAt = [&](uint32_t offset, uint32_t size) {
+        auto it = symbolsByOffset.find(offset);
+        if (it != symbolsByOffset.end()) return it->second;
+        uint32_t symbol = internSymbol(std::string_view(heap + offset, size));
+        symbolsByOffset.emplace(offset, symbol);
+        return symbol;
+    };
+    uint32_t defaultOwner = internSymbol(owner);
+
+    out.reserve(out.size() + header.taskCount);
+    for (uint32_t i = 0; i < header.taskCount; ++i) {
+        BinaryTaskRecord record;
+        memcpy(&record, file.data() + sizeof(header) + i * sizeof(BinaryTaskRecord), sizeof(record));
+        if (header.version == 1) {
+            uint32_t packed = static_cast<uint32_t>(record.dueDay);
+            record.dueDay = Date(packed & 31, (packed >> 5) & 15, packed >> 9).toDays();
+        }
+        if (!inHeap(record.nameOffset, record.nameLength) || !Date::fromDays(record.dueDay).isValid() ||
+            !inHeap(record.categoryOffset, record.categoryLength) ||
+            !inHeap(record.ownerOffset, record.ownerLength) || !isValidPriority(record.priority)) {
+            log << YELLOW << "[WARNING] Skipping invalid task #" << i + 1 << " in " << fileName << RESET << std::endl;
+            continue;
+        }
+
+        uint32_t taskOwner = record.ownerLength == 0 ? defaultOwner : symbolAt(record.ownerOffset, record.ownerLength);
+        out.emplace_back(record.id, std::string(heap + record.nameOffset, record.nameLength), record.priority,
+                         record.dueDay, record.done != 0, symbolAt(record.categoryOffset, record.categoryLength),
+                         taskOwner);
+    }
+    return true;
+}
+
+// Appends the tasks stored in `fileName` (either format) to `out`; tasks without an owner
+// are attributed to `owner`. Returns false only if the file cannot be opened.
+inline bool readTaskSnapshot(const std::string& fileName, const std::string& owner, std::vector<Task>& out, std::ostream& log = std::cout) {
+    std::ifstream inFile(fileName, std::ios::binary);
+    if (!inFile.is_open()) return false;
+    std::error_code sizeError;
+    uintmax_t fileSize = std::filesystem::file_size(fileName, sizeError);
+    if (!sizeError) Metrics::instance().bytesRead += fileSize;
+
+    char magic[sizeof(BINARY_SNAPSHOT_MAGIC)] = {};
+    inFile.read(magic, sizeof(magic));
+    if (inFile.gcount() == sizeof(magic) && memcmp(magic, BINARY_SNAPSHOT_MAGIC, sizeof(magic)) == 0) {
+        inFile.close();
+        return readBinarySnapshot(fileName, owner, out, log);
+    }
+    inFile.clear();
+    inFile.seekg(0);
+
+    TaskFileParser parser(inFile);
+    Task task(0, "", 0, 0);
+    uint32_t generalId = internSymbol("General"), ownerId = internSymbol(owner);
+    bool valid = false;
+    size_t index = 0;
+    while (true) {
+        task.id = 0;
+        task.name.clear();
+        task.priority = 0;
+        task.dueDay = -1;
+        task.done = false;
+        task.categoryId = generalId;
+        task.ownerId = ownerId;
+        if (!parser.next(task, valid)) break;
+        ++index;
+        if (valid && !task.name.empty() && task.dueDay >= 0 && isValidPriority(task.priority)) {
+            out.push_back(task);
+        } else {
+            log << YELLOW << "[WARNING] Skipping invalid task #" << index << " in " << fileName << RESET << std::endl;
+        }
+    }
+    return true;
+}
+
+// Bulk exchange formats for ToDoList::importTasks/exportTasks. CSV files start with a
+// header row naming their columns (id,name,priority,dueDate,done,category,owner; only
+// name, priority and dueDate are required). JSON Lines files hold one task object per
+// line in the snapshot's field layout. Imported ids are ignored and reassigned.
+enum class ExchangeFormat { Csv, JsonLines };
+
+// Uses `formatName` when given, otherwise the file extension (.csv, .jsonl or .ndjson).
+inline bool parseExchangeFormat(const std::string& fileName, const std::string& formatName, ExchangeFormat& format) {
+    std::string name = formatName;
+    if (name.empty()) {
+        std::string extension = std::filesystem::path(fileName).extension().string();
+        name = extension == ".csv" ? "csv" : extension == ".jsonl" || extension == ".ndjson" ? "jsonl" : "";
+    }
+    if (name == "csv") format = ExchangeFormat::Csv;
+    else if (name == "jsonl") format = ExchangeFormat::JsonLines;
+    else return false;
+    return true;
+}
+
+// Reads one RFC 4180 record: fields may be quoted, with "" for a literal quote and line
+// breaks allowed inside quotes. Returns false at end of input.
+inline bool readCsvRecord(std::istream& in, std::vector<std::string>& fields) {
+    fields.clear();
+    std::streambuf* buffer = in.rdbuf();
+    std::string field;
+    bool quoted = false, any = false;
+    for (int c; (c = buffer->sbumpc()) != EOF;) {
+        any = true;
+        if (quoted) {
+            if (c != '"') field += static_cast<char>(c);
+            else if (buffer->sgetc() == '"') field += static_cast<char>(buffer->sbumpc());
+            else quoted = false;
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c == '\n') {
+            fields.push_back(std::move(field));
+            return true;
+        } else if (c != '\r') {
+            field += static_cast<char>(c);
+        }
+    }
+    if (!any) return false;
+    fields.push_back(std::move(field));
+    return true;
+}
+
+inline std::string csvField(std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) return std::string(field);
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += c;
+        if (c == '"') quoted += '"';
+    }
+    return quoted + "\"";
+}
+
+inline void writeTaskCsv(std::ostream& out, const TaskStore& tasks, size_t slot) {
+    out << tasks.id(slot) << ',' << csvField(tasks.name(slot)) << ',' << tasks.priority(slot) << ','
+        << tasks.dueDateString(slot) << ',' << (tasks.done(slot) ? "true" : "false") << ','
+        << csvField(tasks.category(slot)) << ',' << csvField(tasks.owner(slot)) << '\n';
+}
+
+// Writes a snapshot's live rows (all of them, or one owner's) as CSV or JSON Lines and
+// reports the outcome to `log`. Touches nothing but the snapshot, so it may run on any thread.
+inline bool exportSnapshot(const TaskSnapshot& snapshot, std::optional<uint32_t> ownerId, const std::string& fileName,
+                    ExchangeFormat format, std::ostream& log) {
+    MetricTimer timer(Metrics::Export);
+    std::ofstream outFile(fileName, std::ios::binary | std::ios::trunc);
+    if (!outFile.is_open()) {
+        log << RED << "[ERROR] Cannot open file for writing: " << fileName << RESET << std::endl;
+        return false;
+    }
+
+    size_t exported = 0;
+    if (format == ExchangeFormat::Csv) outFile << "id,name,priority,dueDate,done,category,owner\n";
+    snapshot.forEachLive(ownerId, [&](const TaskStore& rows, size_t row) {
+        if (format == ExchangeFormat::Csv) {
+            writeTaskCsv(outFile, rows, row);
+        } else {
+            writeTaskJson(outFile, rows, row);
+            outFile << '\n';
+        }
+        ++exported;
+    });
+    if (!outFile.good()) {
+        log << RED << "[ERROR] Failed to write " << fileName << RESET << std::endl;
+        return false;
+    }
+    Metrics::instance().bytesWritten += static_cast<uint64_t>(outFile.tellp());
+    log << GREEN << "[INFO] Exported " << exported << " task(s) to " << fileName << "." << RESET << std::endl;
+    return true;
+}
+
+// Streams the tasks of an import file through `accept`, one record at a time. Records
+// failing the usual name/priority/due-date rules, or rejected by `accept`, are reported
+// to `log` and skipped. Tasks without an owner column carry the empty-string symbol.
+// Returns false if the file cannot be read at all (for CSV, a missing required column).
+template <typename Accept>
+bool readImportFile(std::istream& in, ExchangeFormat format, const std::string& fileName, Accept accept,
+                    size_t& skipped, std::ostream& log) {
+    uint32_t generalId = internSymbol("General"), noOwner = internSymbol("");
+    Task task(0, "", 0, 0);
+    size_t index = 0;
+    auto offer = [&](bool valid) {
+        ++index;
+        if (!valid || !accept(task)) {
+            ++skipped;
+            log << YELLOW << "[WARNING] Skipping invalid task #" << index << " in " << fileName << RESET << std::endl;
+        }
+    };
+    auto reset = [&] {
+        task.id = 0;
+        task.name.clear();
+        task.priority = 0;
+        task.dueDay = -1;
+        task.done = false;
+        task.categoryId = generalId;
+        task.ownerId = noOwner;
+    };
+
+    if (format == ExchangeFormat::JsonLines) {
+        TaskFileParser parser(in, true);
+        bool valid = false;
+        while (true) {
+            reset();
+            if (!parser.next(task, valid)) break;
+            offer(valid && !task.name.empty() && task.dueDay >= 0 && isValidPriority(task.priority));
+        }
+        return true;
+    }
+
+    std::vector<std::string> fields;
+    if (!readCsvRecord(in, fields)) return false;
+    const std::array<std::string, 6> columnNames = {"name", "priority", "dueDate", "done", "category", "owner"};
+    std::array<size_t, 6> columns;
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+        auto it = std::find_if(fields.begin(), fields.end(), [&](const std::string& field) { return trim(field) == columnNames[i]; });
+        columns[i] = it == fields.end() ? std::string::npos : static_cast<size_t>(it - fields.begin());
+    }
+    if (columns[0] == std::string::npos || columns[1] == std::string::npos || columns[2] == std::string::npos) {
+        log << RED << "[ERROR] CSV header of " << fileName << " needs name, priority and dueDate columns." << RESET << std::endl;
+        return false;
+    }
+    auto column = [&fields, &columns](size_t which) -> const std::string& {
+        static const std::string missing;
+        return columns[which] < fields.size() ? fields[columns[which]] : missing;
+    };
+
+    while (readCsvRecord(in, fields)) {
+        if (fields.size() == 1 && trim(fields[0]).empty()) continue;
+        reset();
+        task.name = column(0);
+        bool valid = !task.name.empty() && parseInt(trim(column(1)), task.priority) &&
+                     isValidPriority(task.priority) && isValidDueDate(trim(column(2)));
+        if (valid) {
+            task.dueDay = Date::fromString(trim(column(2))).toDays();
+            std::string done = trim(column(3));
+            task.done = done == "true" || done == "1" || done == "yes";
+            if (!trim(column(4)).empty()) task.categoryId = internSymbol(trim(column(4)));
+            if (!trim(column(5)).empty()) task.ownerId = internSymbol(trim(column(5)));
+        }
+        offer(valid);
+    }
+    return true;
+}
+
+// Journal records are single tab-separated lines (see ToDoList::appendJournal):
+//   A|E <id> <name> <priority> <due date> <done> <category> <owner>   add / edit, full task state
+//   D|U|X <id>                                                         done / undone / delete
+//   C                                                                  clear every task before it
+// Records written before the owner field take their owner from the caller.
+inline std::string escapeJournalField(const std::string& field) {
+    std::string escaped;
+    escaped.reserve(field.size());
+    for (char c : field) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+inline std::vector<std::string> splitJournalRecord(const std::string& line) {
+    std::vector<std::string> fields(1);
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\t') {
+            fields.emplace_back();
+        } else if (c == '\\' && i + 1 < line.size()) {
+            char next = line[++i];
+            fields.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+inline std::string journalTaskRecord(char op, const Task& task) {
+    return std::string(1, op) + "\t" + std::to_string(task.id) + "\t" + escapeJournalField(task.name) + "\t" +
+           std::to_string(task.priority) + "\t" + task.dueDateString() + "\t" + (task.done ? "1" : "0") + "\t" +
+           escapeJournalField(task.category()) + "\t" + escapeJournalField(task.owner());
+}
+
+// Size and modification time of a file as last seen; a missing file stamps as empty.
+struct FileStamp {
+    std::filesystem::file_time_type time{};
+    uintmax_t size = 0;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+inline FileStamp stampOf(const std::string& fileName) {
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.time = std::filesystem::last_write_time(fileName, ec);
+    if (ec) return {};
+    stamp.size = std::filesystem::file_size(fileName, ec);
+    return ec ? FileStamp() : stamp;
+}
+
+// One user's tasks as they stand after replaying the journal over the snapshot. Loading
+// touches nothing shared, so admin mode can load many users concurrently and merge after.
+struct UserTaskLoad {
+    std::vector<Task> tasks;
+    bool hasSnapshot = false;
+    bool hasJournal = false;
+    size_t snapshotCount = 0;
+    size_t journalRecords = 0;
+    FileStamp snapshotStamp, journalStamp;  // the files as they were read
+    std::string log;  // warnings, printed by whoever merges the result
+};
+
+inline void replayJournalFile(const std::string& fileName, const std::string& owner, UserTaskLoad& loaded, std::ostream& log) {
+    std::ifstream inFile(fileName);
+    if (!inFile.is_open()) return;
+    loaded.hasJournal = true;
+
+    std::vector<Task>& tasks = loaded.tasks;
+    std::unordered_map<int, size_t> slots;
+    for (size_t slot = 0; slot < tasks.size(); ++slot) {
+        slots[tasks[slot].id] = slot;
+    }
+
+    bool anyDeleted = false;
+    std::string line;
+    while (std::getline(inFile, line)) {
+        Metrics::instance().bytesRead += line.size() + 1;
+        if (line.empty()) continue;
+        std::vector<std::string> fields = splitJournalRecord(line);
+        if (fields.size() == 1 && fields[0] == "C") {
+            tasks.clear();
+            slots.clear();
+            anyDeleted = false;
+            ++loaded.journalRecords;
+            continue;
+        }
+        int id = 0;
+        if (fields[0].size() != 1 || fields.size() < 2 || !parseInt(fields[1], id)) {
+            log << YELLOW << "[WARNING] Skipping malformed journal record in " << fileName << RESET << std::endl;
+            continue;
+        }
+
+        auto existing = slots.find(id);
+        char op = fields[0][0];
+        if (op == 'A' || op == 'E') {
+            int priority = 0;
+            if (fields.size() < 7 || fields[2].empty() || !parseInt(fields[3], priority) ||
+                !isValidPriority(priority) || !isValidDueDate(fields[4])) {
+                log << YELLOW << "[WARNING] Skipping malformed journal record in " << fileName << RESET << std::endl;
+                continue;
+            }
+            Task task(id, fields[2], priority, Date::fromString(fields[4]).toDays(), fields[5] == "1", fields[6],
+                      fields.size() > 7 ? fields[7] : owner);
+            if (existing != slots.end()) {
+                tasks[existing->second] = task;
+            } else {
+                slots.emplace(id, tasks.size());
+                tasks.push_back(task);
+            }
+        } else if (op == 'D' || op == 'U') {
+            if (existing != slots.end()) tasks[existing->second].done = (op == 'D');
+        } else if (op == 'X') {
+            if (existing != slots.end()) {
+                tasks[existing->second].deleted = true;
+                slots.erase(existing);
+                anyDeleted = true;
+            }
+        } else {
+            log << YELLOW << "[WARNING] Unknown journal operation '" << op << "' in " << fileName << RESET << std::endl;
+            continue;
+        }
+        ++loaded.journalRecords;
+    }
+
+    if (anyDeleted) {
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](const Task& task) { return task.deleted; }),
+                    tasks.end());
+    }
+}
+
+// Callers hold the owner's lock (see taskLockFileName), at least shared.
+inline UserTaskLoad loadUserTasks(const std::string& snapshotFile, const std::string& journalFile, const std::string& owner) {
+    UserTaskLoad loaded;
+    loaded.snapshotStamp = stampOf(snapshotFile);
+    loaded.journalStamp = stampOf(journalFile);
+    std::ostringstream log;
+    loaded.hasSnapshot = readTaskSnapshot(snapshotFile, owner, loaded.tasks, log);
+    loaded.snapshotCount = loaded.tasks.size();
+    replayJournalFile(journalFile, owner, loaded, log);
+    Metrics::instance().tasksLoaded += loaded.tasks.size();
+    loaded.log = log.str();
+    return loaded;
+}
+
+// SHA-256 (FIPS 180-4), the primitive behind password hashing below.
+class Sha256 {
+private:
+    static constexpr uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t block[64];
+    size_t blockSize = 0;
+    uint64_t totalBytes = 0;
+
+    void compress() {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = uint32_t(block[i * 4]) << 24 | uint32_t(block[i * 4 + 1]) << 16 |
+                   uint32_t(block[i * 4 + 2]) << 8 | uint32_t(block[i * 4 + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    void update(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        totalBytes += size;
+        while (size > 0) {
+            size_t chunk = std::min(size, sizeof(block) - blockSize);
+            memcpy(block + blockSize, bytes, chunk);
+            blockSize += chunk;
+            bytes += chunk;
+            size -= chunk;
+            if (blockSize == sizeof(block)) {
+                compress();
+                blockSize = 0;
+            }
+        }
+    }
+
+    Digest finish() {
+        uint64_t bitLength = totalBytes * 8;
+        uint8_t padding = 0x80;
+        update(&padding, 1);
+        padding = 0;
+        while (blockSize != 56) update(&padding, 1);
+        for (int i = 7; i >= 0; --i) {
+            uint8_t byte = static_cast<uint8_t>(bitLength >> (i * 8));
+            update(&byte, 1);
+        }
+        Digest digest;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (24 - j * 8));
+        }
+        return digest;
+    }
+};
+
+// PBKDF2-HMAC-SHA256 with a single 32-byte output block. The keyed inner/outer hash
+// states are prepared once, so each iteration costs exactly two compressions.
+inline Sha256::Digest pbkdf2Sha256(const std::string& password, const std::string& salt, uint32_t iterations) {
+    uint8_t key[64] = {};
+    if (password.size() > sizeof(key)) {
+        Sha256 hasher;
+        hasher.update(password.data(), password.size());
+        Sha256::Digest digest = hasher.finish();
+        memcpy(key, digest.data(), digest.size());
+    } else {
+        memcpy(key, password.data(), password.size());
+    }
+    uint8_t innerPad[64], outerPad[64];
+    for (int i = 0; i < 64; ++i) {
+        innerPad[i] = key[i] ^ 0x36;
+        outerPad[i] = key[i] ^ 0x5c;
+    }
+    Sha256 inner, outer;
+    inner.update(innerPad, sizeof(innerPad));
+    outer.update(outerPad, sizeof(outerPad));
+    auto hmac = [&](const void* data, size_t size, const void* more = nullptr, size_t moreSize = 0) {
+        Sha256 innerHash = inner, outerHash = outer;
+        innerHash.update(data, size);
+        if (more) innerHash.update(more, moreSize);
+        Sha256::Digest innerDigest = innerHash.finish();
+        outerHash.update(innerDigest.data(), innerDigest.size());
+        return outerHash.finish();
+    };
+
+    const uint8_t blockIndex[4] = {0, 0, 0, 1};
+    Sha256::Digest u = hmac(salt.data(), salt.size(), blockIndex, sizeof(blockIndex));
+    Sha256::Digest result = u;
+    for (uint32_t i = 1; i < iterations; ++i) {
+        u = hmac(u.data(), u.size());
+        for (size_t j = 0; j < result.size(); ++j) result[j] ^= u[j];
+    }
+    return result;
+}
+
+inline std::string toHex(const uint8_t* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 15];
+    }
+    return hex;
+}
+
+inline bool fromHex(const std::string& hex, std::string& out) {
+    if (hex.size() % 2 != 0) return false;
+    auto nibble = [](char c) {
+        return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    };
+    out.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = nibble(hex[i]), low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0) return false;
+        out += static_cast<char>(high << 4 | low);
+    }
+    return true;
+}
+
+// Work factor for new password hashes; TODO_HASH_ITERATIONS tunes it per deployment.
+// Stored hashes record their own count, so changing it only affects new hashes.
+inline uint32_t passwordHashIterations() {
+    static const uint32_t iterations = [] {
+        const char* value = getenv("TODO_HASH_ITERATIONS");
+        int parsed = 0;
+        return value && parseInt(value, parsed) && parsed > 0 ? static_cast<uint32_t>(parsed) : 100000u;
+    }();
+    return iterations;
+}
+
+const std::string PASSWORD_HASH_PREFIX = "pbkdf2-sha256$";
+
+// Returns a self-describing salted hash: pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>.
+inline std::string simpleHash(const std::string& input) {
+    std::random_device random;
+    uint8_t salt[16];
+    for (uint8_t& byte : salt) byte = static_cast<uint8_t>(random());
+    std::string saltBytes(reinterpret_cast<const char*>(salt), sizeof(salt));
+    uint32_t iterations = passwordHashIterations();
+    Sha256::Digest digest = pbkdf2Sha256(input, saltBytes, iterations);
+    return PASSWORD_HASH_PREFIX + std::to_string(iterations) + "$" + toHex(salt, sizeof(salt)) + "$" +
+           toHex(digest.data(), digest.size());
+}
+
+// Accepts hashes produced by simpleHash and, for accounts created before hashing was
+// introduced, plain-text passwords (which the caller should then upgrade).
+inline bool verifyPassword(const std::string& password, const std::string& stored, bool& isLegacy) {
+    isLegacy = stored.rfind(PASSWORD_HASH_PREFIX, 0) != 0;
+    if (isLegacy) return password == stored;
+
+    size_t first = PASSWORD_HASH_PREFIX.size();
+    size_t second = stored.find('$', first);
+    size_t third = second == std::string::npos ? std::string::npos : stored.find('$', second + 1);
+    int iterations = 0;
+    std::string salt, expected;
+    if (third == std::string::npos || !parseInt(stored.substr(first, second - first), iterations) || iterations <= 0 ||
+        !fromHex(stored.substr(second + 1, third - second - 1), salt) || !fromHex(stored.substr(third + 1), expected) ||
+        expected.size() != sizeof(Sha256::Digest)) {
+        return false;
+    }
+    Sha256::Digest digest = pbkdf2Sha256(password, salt, static_cast<uint32_t>(iterations));
+    uint8_t difference = 0;
+    for (size_t i = 0; i < digest.size(); ++i) difference |= digest[i] ^ static_cast<uint8_t>(expected[i]);
+    return difference == 0;
+}
+
+// Advisory lock on a companion ".lock" file, so processes sharing a data directory see
+// each other's writes whole. Readers share the lock and writers hold it exclusively.
+// The lock is tied to its own descriptor, so a thread must not take a second lock on a
+// file it already holds. Locking is a no-op on Windows.
+class FileLock {
+public:
+    enum Mode { Shared, Exclusive };
+
+private:
+    int fd = -1;
+
+public:
+    FileLock() = default;
+    FileLock(const std::string& lockFile, Mode mode) { lock(lockFile, mode); }
+    ~FileLock() { unlock(); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+    FileLock(FileLock&& other) noexcept : fd(std::exchange(other.fd, -1)) {}
+    FileLock& operator=(FileLock&& other) noexcept {
+        if (this != &other) {
+            unlock();
+            fd = std::exchange(other.fd, -1);
+        }
+        return *this;
+    }
+
+    // Blocks until the lock is granted. Returns false (and leaves nothing held) if the
+    // lock file cannot be opened, in which case the caller proceeds unlocked.
+    bool lock(const std::string& lockFile, Mode mode) {
+        unlock();
+#ifndef _WIN32
+        fd = ::open(lockFile.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        while (flock(fd, mode == Exclusive ? LOCK_EX : LOCK_SH) != 0) {
+            if (errno != EINTR) {
+                unlock();
+                return false;
+            }
+        }
+#else
+        (void)lockFile;
+        (void)mode;
+#endif
+        return true;
+    }
+
+    void unlock() {
+#ifndef _WIN32
+        if (fd >= 0) ::close(fd);  // closing the descriptor releases the lock
+#endif
+        fd = -1;
+    }
+
+    bool held() const { return fd >= 0; }
+};
+
+// "tasks_bob.txt" -> "tasks_bob.lock"; every writer of a user's snapshot or journal
+// holds this lock exclusively.
+inline std::string taskLockFileName(const std::string& taskFileName) {
+    return std::filesystem::path(taskFileName).replace_extension(".lock").string();
+}
+
+// In-memory view of users.txt. The file is parsed once into a hash map and re-parsed
+// only when its size or modification time changes underneath us. Registrations,
+// password upgrades and removals are appended as single lines (later lines win; a
+// "!name" line removes the user), and the file is rewritten only once superseded
+// lines outnumber live ones, or when a plain-text password has just been upgraded.
+// Every read and write happens under users.lock, so other processes never see a
+// half-written line or a file mid-rewrite. The server verifies logins on worker threads,
+// so the in-memory view is also guarded by a mutex, always taken before users.lock.
+class UserDirectory {
+private:
+    struct UserEntry {
+        std::string passwordHash;
+        size_t order;
+    };
+
+    static constexpr const char* FILE_NAME = "users.txt";
+    static constexpr const char* LOCK_FILE_NAME = "users.lock";
+    static constexpr size_t MIN_COMPACT_LINES = 64;
+    std::unordered_map<std::string, UserEntry> users;
+    size_t nextOrder = 0;
+    size_t staleLines = 0;
+    bool loaded = false;
+    std::filesystem::file_time_type seenTime;
+    uintmax_t seenSize = 0;
+    std::mutex mutex;
+
+    static std::string formatUsername(const std::string& username) {
+        return username.find(' ') != std::string::npos ? "\"" + username + "\"" : username;
+    }
+
+    static std::string unquote(std::string name) {
+        name = trim(name);
+        if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+            name = name.substr(1, name.size() - 2);
+        }
+        return name;
+    }
+
+    void rememberFileState() {
+        std::error_code ec;
+        seenTime = std::filesystem::last_write_time(FILE_NAME, ec);
+        seenSize = ec ? 0 : std::filesystem::file_size(FILE_NAME, ec);
+    }
+
+    bool fileChanged() {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(FILE_NAME, ec);
+        if (ec) return loaded && !users.empty();
+        uintmax_t size = std::filesystem::file_size(FILE_NAME, ec);
+        return !loaded || time != seenTime || size != seenSize;
+    }
+
+    void reloadIfChanged() {
+        if (!fileChanged()) return;
+        users.clear();
+        nextOrder = 0;
+        staleLines = 0;
+        loaded = true;
+
+        std::ifstream inFile(FILE_NAME);
+        std::string line;
+        while (std::getline(inFile, line)) {
+            line = trim(line);
+            if (line.empty()) continue;
+            if (line[0] == '!') {
+                staleLines += users.erase(unquote(line.substr(1))) + 1;
+                continue;
+            }
+            size_t commaPos = line.find(',');
+            if (commaPos == std::string::npos) continue;
+
+            std::string username = unquote(line.substr(0, commaPos));
+            auto [it, inserted] = users.try_emplace(username, UserEntry{"", nextOrder});
+            if (inserted) ++nextOrder;
+            else ++staleLines;
+            it->second.passwordHash = trim(line.substr(commaPos + 1));
+        }
+        rememberFileState();
+    }
+
+    bool appendLine(const std::string& line, std::ostream& log = std::cout) {
+        std::ofstream outFile(FILE_NAME, std::ios::app);
+        if (!outFile.is_open()) {
+            log << RED << "[ERROR] Cannot open users file for writing." << RESET << std::endl;
+            return false;
+        }
+        outFile << line << "\n";
+        outFile.close();
+        rememberFileState();
+        return true;
+    }
+
+    std::vector<std::string> orderedNames() const {
+        std::vector<std::pair<size_t, std::string>> ordered;
+        for (const auto& [username, entry] : users) ordered.emplace_back(entry.order, username);
+        std::sort(ordered.begin(), ordered.end());
+        std::vector<std::string> names;
+        for (auto& [order, username] : ordered) names.push_back(std::move(username));
+        return names;
+    }
+
+    void compactIfStale(bool force = false) {
+        if (!force && (staleLines < MIN_COMPACT_LINES || staleLines <= users.size())) return;
+        std::ofstream outFile(FILE_NAME, std::ios::trunc);
+        if (!outFile.is_open()) return;
+        for (const std::string& username : orderedNames()) {
+            outFile << formatUsername(username) << "," << users[username].passwordHash << "\n";
+        }
+        outFile.close();
+        staleLines = 0;
+        rememberFileState();
+    }
+
+public:
+    static UserDirectory& instance() {
+        static UserDirectory directory;
+        return directory;
+    }
+
+    bool exists(const std::string& username) {
+        std::lock_guard guard(mutex);
+        FileLock lock(LOCK_FILE_NAME, FileLock::Shared);
+        reloadIfChanged();
+        return users.count(username) > 0;
+    }
+
+    bool fileAvailable() {
+        std::lock_guard guard(mutex);
+        FileLock lock(LOCK_FILE_NAME, FileLock::Shared);
+        reloadIfChanged();
+        return std::filesystem::exists(FILE_NAME);
+    }
+
+    // Fails with a message if another process registered the name since exists() said no.
+    bool add(const std::string& username, const std::string& password) {
+        std::string hash = simpleHash(password);  // slow on purpose; keep it outside the lock
+        std::lock_guard guard(mutex);
+        FileLock lock(LOCK_FILE_NAME, FileLock::Exclusive);
+        reloadIfChanged();
+        if (users.count(username) > 0) {
+            std::cout << RED << "[ERROR] Username already exists." << RESET << std::endl;
+            return false;
+        }
+        if (!appendLine(formatUsername(username) + "," + hash)) return false;
+        users[username] = UserEntry{hash, nextOrder++};
+        compactIfStale();
+        return true;
+    }
+
+    bool verify(const std::string& username, const std::string& password, std::ostream& log = std::cout) {
+        std::string stored;
+        {
+            std::lock_guard guard(mutex);
+            FileLock lock(LOCK_FILE_NAME, FileLock::Shared);
+            reloadIfChanged();
+            auto it = users.find(username);
+            if (it == users.end()) return false;
+            stored = it->second.passwordHash;
+        }
+        bool isLegacy = false;
+        if (!verifyPassword(password, stored, isLegacy)) return false;
+        if (isLegacy) {
+            std::string hash = simpleHash(password);
+            std::lock_guard guard(mutex);
+            FileLock lock(LOCK_FILE_NAME, FileLock::Exclusive);
+            reloadIfChanged();
+            auto it = users.find(username);
+            if (it != users.end() && it->second.passwordHash == stored &&
+                appendLine(formatUsername(username) + "," + hash, log)) {
+                it->second.passwordHash = hash;
+                ++staleLines;
+                compactIfStale(true);  // don't leave the plain-text line on disk
+            }
+        }
+        return true;
+    }
+
+    bool remove(const std::string& username) {
+        std::lock_guard guard(mutex);
+        FileLock lock(LOCK_FILE_NAME, FileLock::Exclusive);
+        reloadIfChanged();
+        if (users.find(username) == users.end() || !appendLine("!" + formatUsername(username))) return false;
+        users.erase(username);
+        staleLines += 2;
+        compactIfStale();
+        return true;
+    }
+
+    // Usernames in registration order.
+    std::vector<std::string> list() {
+        std::lock_guard guard(mutex);
+        FileLock lock(LOCK_FILE_NAME, FileLock::Shared);
+        reloadIfChanged();
+        return orderedNames();
+    }
+};
+
+// Rows per screen for interactive task listings; TODO_PAGE_SIZE=0 turns paging off.
+inline size_t configuredPageSize() {
+    static const size_t pageSize = [] {
+        const char* value = getenv("TODO_PAGE_SIZE");
+        int parsed = 0;
+        return value && parseInt(value, parsed) && parsed >= 0 ? static_cast<size_t>(parsed) : size_t(50);
+    }();
+    return pageSize;
+}
+
+// Paging prompts only make sense when a person is typing; piped input is never paged.
+inline bool stdinIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdin));
+#else
+    return isatty(STDIN_FILENO);
+#endif
+}
+
+// Formats the task table shared by every listing. Rows are appended to one reusable
+// buffer with hand-rolled padding and handed to cout in a single write per page.
+class TaskTableRenderer {
+private:
+    static constexpr size_t TABLE_WIDTH = 100;
+    std::string buffer;
+    bool showOwner;
+
+    void cell(std::string_view text, size_t width, size_t maxChars) {
+        text = text.substr(0, maxChars);
+        buffer.append(text);
+        if (text.size() < width) buffer.append(width - text.size(), ' ');
+    }
+
+    void number(int value, size_t width) {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        cell(std::string_view(digits, result.ptr - digits), width, width);
+    }
+
+    void date(int dueDay, size_t width) {
+        Date date = Date::fromDays(dueDay);
+        char text[10] = {char('0' + date.day / 10), char('0' + date.day % 10), '-',
+                         char('0' + date.month / 10), char('0' + date.month % 10), '-',
+                         char('0' + date.year / 1000), char('0' + date.year / 100 % 10),
+                         char('0' + date.year / 10 % 10), char('0' + date.year % 10)};
+        cell(std::string_view(text, sizeof(text)), width, width);
+    }
+
+    void rule() {
+        buffer += CYAN;
+        buffer.append(TABLE_WIDTH, '=');
+        buffer += RESET "\n";
+    }
+
+public:
+    explicit TaskTableRenderer(bool withOwner) : showOwner(withOwner) {}
+
+    void header() {
+        rule();
+        buffer += CYAN "| ";
+        cell("ID", 6, 6);
+        cell("Task Name", 26, 26);
+        cell("Priority", 11, 11);
+        cell("Due Date", 13, 13);
+        cell("Status", 11, 11);
+        cell("Category", 12, 12);
+        cell(showOwner ? "Owner" : "", 18, 18);
+        buffer += "|" RESET "\n";
+        rule();
+    }
+
+    void row(const TaskStore& tasks, size_t slot, int today) {
+        static constexpr std::string_view DONE_STATUS = GREEN "Done" RESET "       ";
+        static constexpr std::string_view OVERDUE_STATUS = YELLOW "Overdue" RESET "    ";
+        static constexpr std::string_view OPEN_STATUS = YELLOW "Not Done" RESET "   ";
+        buffer += "| ";
+        number(tasks.id(slot), 6);
+        cell(tasks.name(slot), 26, 25);
+        number(tasks.priority(slot), 11);
+        date(tasks.dueDay(slot), 13);
+        buffer.append(tasks.done(slot) ? DONE_STATUS : tasks.dueDay(slot) < today ? OVERDUE_STATUS : OPEN_STATUS);
+        cell(tasks.category(slot), 12, 11);
+        cell(showOwner ? std::string_view(tasks.owner(slot)) : std::string_view(), 18, 14);
+        buffer += "|\n";
+    }
+
+    void footer() { rule(); }
+
+    void flush(std::ostream& out = std::cout) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.flush();
+        buffer.clear();
+    }
+};
+
+// Milliseconds the snapshot writer waits after a request before writing, so a burst of
+// requests is written once; TODO_COMMIT_WINDOW_MS overrides it.
+inline std::chrono::milliseconds configuredCommitWindow() {
+    static const std::chrono::milliseconds window = [] {
+        const char* value = getenv("TODO_COMMIT_WINDOW_MS");
+        int parsed = 0;
+        return std::chrono::milliseconds(value && parseInt(value, parsed) && parsed >= 0 ? parsed : 10);
+    }();
+    return window;
+}
+
+// Write-behind for snapshot rewrites. Sessions push requests onto a lock-free stack and
+// return at once; one background thread drains it every commit window and keeps only the
+// newest request per session. It writes a temporary file without holding any lock, then
+// takes the owner's lock just to rename it into place and trim the journal. A request
+// carries an immutable TaskSnapshot, so the session can keep changing in the meantime.
+//
+// Only journal compactions come here. Everything they would write is already in the
+// journal, so a request whose file another writer replaced in the meantime is dropped.
+// Records appended after the snapshot was taken are kept; only the covered prefix of the
+// journal is removed.
+class SnapshotWriter {
+public:
+    // What one session has outstanding, shared with the writer thread.
+    struct Session {
+        // A finished write, for the session to adopt the new file stamps.
+        struct Result {
+            std::string snapshotFile;
+            FileStamp snapshotBefore, snapshotAfter;
+            bool journalTrimmed = false;
+            FileStamp journalBefore, journalAfter;
+        };
+
+        std::atomic<uint64_t> completed{0};  // sequence number of the newest request handled
+        std::mutex guard;
+        std::vector<Result> results;
+        std::string log;  // errors from the writer thread, printed by the session
+    };
+
+    struct Request {
+        std::shared_ptr<Session> session;
+        uint64_t sequence = 0;
+        std::shared_ptr<const TaskSnapshot> snapshot;
+        std::optional<uint32_t> ownerId;
+        std::string snapshotFile, journalFile;
+        SnapshotFormat format = SnapshotFormat::Text;
+        FileStamp expectedSnapshot, coveredJournal;  // the files when the snapshot was taken
+    };
+
+private:
+    struct Node {
+        Request request;
+        Node* next = nullptr;
+    };
+
+    std::atomic<Node*> pending{nullptr};
+    std::atomic<uint64_t> signal{0};
+    std::atomic<bool> stopping{false};
+    std::once_flag started;
+    std::thread worker;
+
+    SnapshotWriter() = default;
+
+    ~SnapshotWriter() {
+        if (!worker.joinable()) return;
+        stopping = true;
+        signal.fetch_add(1);
+        signal.notify_one();
+        worker.join();
+    }
+
+    void run() {
+        uint64_t seen = 0;
+        for (;;) {
+            if (!stopping) {
+                signal.wait(seen);
+                seen = signal.load();
+                std::this_thread::sleep_for(configuredCommitWindow());
+            }
+            Node* batch = pending.exchange(nullptr, std::memory_order_acquire);
+            if (!batch) {
+                if (stopping) return;
+                continue;
+            }
+
+            // The stack is newest-first, so the first request seen for a session's file wins.
+            std::vector<std::unique_ptr<Node>> newest;
+            while (batch) {
+                std::unique_ptr<Node> node(batch);
+                batch = batch->next;
+                bool superseded = std::any_of(newest.begin(), newest.end(), [&](const std::unique_ptr<Node>& kept) {
+                    return kept->request.session == node->request.session &&
+                           kept->request.snapshotFile == node->request.snapshotFile;
+                });
+                if (!superseded) newest.push_back(std::move(node));
+            }
+            for (auto it = newest.rbegin(); it != newest.rend(); ++it) {
+                Request& request = (*it)->request;
+                write(request);
+                request.session->completed.store(request.sequence);
+                request.session->completed.notify_all();
+            }
+        }
+    }
+
+    // Drops the first `covered` bytes of the journal, keeping anything appended since.
+    static bool trimJournal(const std::string& journalFile, uintmax_t covered, std::ostream& log) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(journalFile, ec);
+        if (ec || size < covered) return false;
+        if (size == covered) {
+            std::ofstream(journalFile, std::ios::trunc).close();
+            return true;
+        }
+        std::ifstream inFile(journalFile, std::ios::binary);
+        inFile.seekg(static_cast<std::streamoff>(covered));
+        std::string tempName = journalFile + ".tmp";
+        std::ofstream outFile(tempName, std::ios::binary | std::ios::trunc);
+        outFile << inFile.rdbuf();
+        outFile.close();
+        if (!outFile.fail()) std::filesystem::rename(tempName, journalFile, ec);
+        if (outFile.fail() || ec) {
+            log << RED << "[ERROR] Cannot trim journal " << journalFile << RESET << std::endl;
+            std::filesystem::remove(tempName, ec);
+            return false;
+        }
+        return true;
+    }
+
+    static void write(const Request& request) {
+        MetricTimer timer(Metrics::SaveSnapshot);
+        Session& session = *request.session;
+        std::ostringstream log;
+        Session::Result result;
+        result.snapshotFile = request.snapshotFile;
+        result.snapshotBefore = request.expectedSnapshot;
+        // Other processes may write behind for the same user, so the name must be ours alone.
+        std::string tempName = request.snapshotFile + ".tmp" + std::to_string(std::random_device()());
+        FileLock lock;
+        if (writeTaskSnapshot(tempName, *request.snapshot, request.ownerId, request.format, log)) {
+            lock.lock(taskLockFileName(request.snapshotFile), FileLock::Exclusive);
+            std::error_code ec;
+            bool replaced = false;
+            if (stampOf(request.snapshotFile) == request.expectedSnapshot) {
+                std::filesystem::rename(tempName, request.snapshotFile, ec);
+                if (ec) log << RED << "[ERROR] Cannot replace " << request.snapshotFile << ": " << ec.message() << RESET << std::endl;
+                replaced = !ec;
+            }
+            if (replaced) {
+                result.snapshotAfter = stampOf(request.snapshotFile);
+                result.journalBefore = stampOf(request.journalFile);
+                result.journalTrimmed = trimJournal(request.journalFile, request.coveredJournal.size, log);
+                result.journalAfter = stampOf(request.journalFile);
+            }
+        }
+        std::error_code ignored;
+        std::filesystem::remove(tempName, ignored);  // left over unless it was renamed
+        // Published before the file lock is released, so the session's next change sees
+        // the new stamps instead of mistaking this write for another session's.
+        std::lock_guard guard(session.guard);
+        if (result.snapshotAfter != FileStamp()) session.results.push_back(result);
+        session.log += log.str();
+    }
+
+public:
+    static SnapshotWriter& instance() {
+        static SnapshotWriter writer;
+        return writer;
+    }
+
+    void submit(Request request) {
+        std::call_once(started, [this] { worker = std::thread([this] { run(); }); });
+        Node* node = new Node{std::move(request)};
+        node->next = pending.load(std::memory_order_relaxed);
+        while (!pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        signal.fetch_add(1);
+        signal.notify_one();
+    }
+
+    // Blocks until every request up to `sequence` from this session has been handled.
+    static void waitFor(Session& session, uint64_t sequence) {
+        for (uint64_t done; (done = session.completed.load()) < sequence;) session.completed.wait(done);
+    }
+};
+
+class ToDoList {
+private:
+    friend struct ToDoListBenchmark;  // bench/benchmark.cpp times the private load/save paths
+
+    TaskStore tasks;
+    int nextId;
+    std::string currentUser;
+    uint32_t currentUserId;
+    bool isAdmin;
+    std::string taskFileName;
+
+    // Tasks are addressed by (owner, id): ids are only unique within one user's file and
+    // admin mode merges every file into `tasks`. Deleted tasks stay in place as tombstones
+    // so slots remain stable; compactTasks() drops them once they make up half the vector.
+    std::unordered_map<uint64_t, size_t> slotIndex;  // taskKey(owner, id) -> slot
+    size_t deletedCount = 0;
+    static constexpr size_t MIN_COMPACT_TOMBSTONES = 64;
+
+    // Secondary indexes let filters enumerate matching slots instead of testing every task.
+    // Slot lists are kept sorted, so they preserve storage order and intersect by merging.
+    std::unordered_map<uint32_t, std::vector<size_t>> ownerSlots;
+    std::unordered_map<uint32_t, std::vector<size_t>> categorySlots;
+    std::vector<uint64_t> doneBits;
+
+    // Overdue tracking. Incomplete tasks that are not yet overdue wait in a min-heap keyed by
+    // due day, and advanceOverdue() moves the ones that have expired into `overdueSlots`, so
+    // neither the login warning nor a day rollover looks at any other task. Heap entries are
+    // dropped lazily: one that no longer matches its slot (deleted, done or re-dated) is
+    // discarded when it surfaces.
+    using DueEntry = std::pair<int, size_t>;  // (due day, slot)
+    std::priority_queue<DueEntry, std::vector<DueEntry>, std::greater<DueEntry>> dueHeap;
+    std::set<DueEntry> overdueSlots;
+    int overdueAsOf = Date::today();
+
+    static void insertSlot(std::vector<size_t>& slots, size_t slot) {
+        if (slots.empty() || slots.back() < slot) slots.push_back(slot);
+        else slots.insert(std::lower_bound(slots.begin(), slots.end(), slot), slot);
+    }
+
+    template <typename Key>
+    static void eraseSlot(std::unordered_map<Key, std::vector<size_t>>& index, const Key& key, size_t slot) {
+        auto it = index.find(key);
+        if (it == index.end()) return;
+        auto pos = std::lower_bound(it->second.begin(), it->second.end(), slot);
+        if (pos != it->second.end() && *pos == slot) it->second.erase(pos);
+        if (it->second.empty()) index.erase(it);
+    }
+
+    bool isDoneSlot(size_t slot) const {
+        return slot / 64 < doneBits.size() && (doneBits[slot / 64] >> (slot % 64) & 1);
+    }
+
+    void setDone(size_t slot, bool done) {
+        markChunkDirty(slot);
+        adjustProgress(slot, 0, int(done) - int(tasks.done(slot)));
+        tasks.setDone(slot, done);
+        setDoneBit(slot, done);
+        if (done) untrackDue(slot);
+        else trackDue(slot);
+    }
+
+    // Every change publishes a snapshot: mutations mark the chunks they touch, and
+    // publishSnapshot() rebuilds just those chunks before swapping the new version in.
+    // Readers on other threads, and the background SnapshotWriter, load `published`
+    // atomically and never wait for a writer, which in turn never copies the whole store.
+    // Writers themselves must still be serialised by the caller. Snapshots carry rows only,
+    // not the secondary indexes, so the jobs that read them on other threads (exports and
+    // the snapshot list, search and urgent queries) scan the rows instead.
+    std::vector<TaskSnapshot::Chunk> snapshotChunks;
+    std::vector<bool> dirtyChunks;
+    uint64_t snapshotVersion = 0;
+    std::atomic<std::shared_ptr<const TaskSnapshot>> published;
+
+    void markChunkDirty(size_t slot) {
+        size_t chunk = slot / TaskSnapshot::CHUNK_ROWS;
+        if (chunk >= dirtyChunks.size()) dirtyChunks.resize(chunk + 1, true);
+        dirtyChunks[chunk] = true;
+    }
+
+    std::shared_ptr<const TaskSnapshot> captureSnapshot() {
+        constexpr size_t CHUNK_ROWS = TaskSnapshot::CHUNK_ROWS;
+        size_t chunkCount = (tasks.size() + CHUNK_ROWS - 1) / CHUNK_ROWS;
+        snapshotChunks.resize(chunkCount);
+        dirtyChunks.resize(chunkCount, true);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            if (!dirtyChunks[chunk]) continue;
+            auto rows = std::make_shared<TaskStore>();
+            size_t end = std::min(tasks.size(), (chunk + 1) * CHUNK_ROWS);
+            rows->reserve(end - chunk * CHUNK_ROWS);
+            for (size_t slot = chunk * CHUNK_ROWS; slot < end; ++slot) rows->push_back(tasks.get(slot));
+            snapshotChunks[chunk] = std::move(rows);
+            dirtyChunks[chunk] = false;
+        }
+        return std::make_shared<const TaskSnapshot>(++snapshotVersion, snapshotChunks);
+    }
+
+    void publishSnapshot() { published.store(captureSnapshot()); }
+
+    // The store as it is now, including a change that has not been published yet.
+    std::shared_ptr<const TaskSnapshot> currentSnapshot() {
+        publishSnapshot();
+        return published.load();
+    }
+
+    // Progress counters, kept current by the index hooks so the progress lines never scan.
+    struct Progress {
+        size_t total = 0;
+        size_t completed = 0;
+    };
+
+    Progress overallProgress;
+    std::unordered_map<uint32_t, Progress> ownerProgress;
+    std::unordered_map<uint32_t, Progress> categoryProgress;
+    std::unordered_map<uint64_t, Progress> ownerCategoryProgress;  // owner << 32 | category
+
+    void adjustProgress(size_t slot, int total, int completed) {
+        uint32_t owner = tasks.ownerId(slot), category = tasks.categoryId(slot);
+        for (Progress* progress : {&overallProgress, &ownerProgress[owner], &categoryProgress[category],
+                                   &ownerCategoryProgress[uint64_t(owner) << 32 | category]}) {
+            progress->total += total;
+            progress->completed += completed;
+        }
+    }
+
+    template <typename Key>
+    static Progress findProgress(const std::unordered_map<Key, Progress>& counters, Key key) {
+        auto it = counters.find(key);
+        return it == counters.end() ? Progress() : it->second;
+    }
+
+    static void printProgress(const std::string& label, const Progress& progress, std::ostream& out = std::cout) {
+        double percent = progress.total > 0 ? (static_cast<double>(progress.completed) / progress.total) * 100 : 0;
+        out << BLUE << label << ": " << std::fixed << std::setprecision(2) << percent << "% completed (" << progress.completed
+             << " of " << progress.total << " tasks)" << RESET << "\n";
+    }
+
+    bool isPendingDue(const DueEntry& entry) const {
+        size_t slot = entry.second;
+        return slot < tasks.size() && !tasks.deleted(slot) && !tasks.done(slot) && tasks.dueDay(slot) == entry.first;
+    }
+
+    void trackDue(size_t slot) {
+        if (tasks.done(slot)) return;
+        if (tasks.dueDay(slot) < overdueAsOf) {
+            overdueSlots.emplace(tasks.dueDay(slot), slot);
+            return;
+        }
+        dueHeap.emplace(tasks.dueDay(slot), slot);
+        if (dueHeap.size() > 2 * getTaskCount() + MIN_COMPACT_TOMBSTONES) {
+            // Mostly stale entries from edits and completions; keep only the live ones.
+            std::vector<DueEntry> live;
+            for (; !dueHeap.empty(); dueHeap.pop()) {
+                if (isPendingDue(dueHeap.top())) live.push_back(dueHeap.top());
+            }
+            live.erase(std::unique(live.begin(), live.end()), live.end());
+            dueHeap = decltype(dueHeap)(std::greater<DueEntry>(), std::move(live));
+        }
+    }
+
+    void untrackDue(size_t slot) { overdueSlots.erase({tasks.dueDay(slot), slot}); }
+
+    void advanceOverdue(int today) {
+        overdueAsOf = std::max(overdueAsOf, today);
+        while (!dueHeap.empty() && dueHeap.top().first < overdueAsOf) {
+            DueEntry entry = dueHeap.top();
+            dueHeap.pop();
+            if (isPendingDue(entry)) overdueSlots.insert(entry);
+        }
+    }
+
+    void setDoneBit(size_t slot, bool done) {
+        if (slot / 64 >= doneBits.size()) doneBits.resize(slot / 64 + 1, 0);
+        if (done) doneBits[slot / 64] |= uint64_t(1) << (slot % 64);
+        else doneBits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+
+    // Substring search index: every trigram of the lower-cased name and category maps to
+    // the sorted slots containing it. A query intersects the lists of its own trigrams and
+    // only the surviving candidates are checked with a real substring match.
+    std::unordered_map<uint32_t, std::vector<size_t>> trigramSlots;
+
+    static std::string toLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return tolower(c); });
+        return text;
+    }
+
+    static void collectTrigrams(const std::string& lowerText, std::vector<uint32_t>& out) {
+        for (size_t i = 0; i + 3 <= lowerText.size(); ++i) {
+            out.push_back(uint32_t(uint8_t(lowerText[i])) << 16 | uint32_t(uint8_t(lowerText[i + 1])) << 8 |
+                          uint8_t(lowerText[i + 2]));
+        }
+    }
+
+    std::vector<uint32_t> taskTrigrams(size_t slot) const {
+        std::vector<uint32_t> trigrams;
+        collectTrigrams(toLower(std::string(tasks.name(slot))), trigrams);
+        collectTrigrams(toLower(tasks.category(slot)), trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        return trigrams;
+    }
+
+    static bool matchesQuery(const TaskStore& rows, size_t row, const std::string& queryLower) {
+        return toLower(std::string(rows.name(row))).find(queryLower) != std::string::npos ||
+               toLower(rows.category(row)).find(queryLower) != std::string::npos;
+    }
+
+    TaskRow liveRow(size_t slot) const { return {tasks, slot}; }
+
+    // Display order. Sorting only selects a key; the permutation of live slots for each key
+    // is built on first use and cached until a slot moves or a sort column changes.
+    enum class SortKey { Storage, Priority, Date, Name, Owner, COUNT };
+
+    struct SortedView {
+        uint64_t generation = std::numeric_limits<uint64_t>::max();
+        std::vector<size_t> order;   // live slots in display order
+        std::vector<uint32_t> rank;  // slot -> position in `order`
+    };
+
+    SortKey viewKey = SortKey::Storage;
+    std::array<SortedView, size_t(SortKey::COUNT)> sortedViews;
+    uint64_t indexGeneration = 0;  // bumped whenever the secondary indexes change
+
+    bool parseSortKey(const std::string& criterion, SortKey& key) const {
+        if (criterion == "priority") key = SortKey::Priority;
+        else if (criterion == "date") key = SortKey::Date;
+        else if (criterion == "name") key = SortKey::Name;
+        else if (criterion == "owner" && isAdmin) key = SortKey::Owner;
+        else return false;
+        return true;
+    }
+
+    // Alphabetical rank of each owner, indexed by owner id; symbol ids follow first-seen order.
+    static std::vector<uint32_t> ownerRanks(const std::vector<uint32_t>& ownerIds) {
+        std::vector<std::pair<std::string_view, uint32_t>> owners;
+        for (uint32_t id : ownerIds) owners.emplace_back(symbolName(id), id);
+        std::sort(owners.begin(), owners.end());
+        std::vector<uint32_t> rank(ownerIds.empty() ? 0 : *std::max_element(ownerIds.begin(), ownerIds.end()) + 1);
+        for (size_t i = 0; i < owners.size(); ++i) rank[owners[i].second] = uint32_t(i);
+        return rank;
+    }
+
+    // Each key breaks ties on the remaining columns, then on the slot, so an order is fully
+    // deterministic. `at(slot)` gives the row a slot refers to.
+    template <typename At>
+    static void sortSlots(SortKey key, std::vector<size_t>& slots, const std::vector<uint32_t>& ownerRank, At at) {
+        auto sortBy = [&](auto columns) {
+            std::sort(slots.begin(), slots.end(), [&](size_t a, size_t b) {
+                auto [rowsA, rowA] = at(a);
+                auto [rowsB, rowB] = at(b);
+                return columns(rowsA, rowA, a) < columns(rowsB, rowB, b);
+            });
+        };
+        switch (key) {
+            case SortKey::Priority:
+                sortBy([&](const TaskStore& t, size_t r, size_t s) {
+                    return std::tuple(t.priority(r), t.dueDay(r), t.name(r), ownerRank[t.ownerId(r)], s);
+                });
+                break;
+            case SortKey::Date:
+                sortBy([&](const TaskStore& t, size_t r, size_t s) {
+                    return std::tuple(t.dueDay(r), t.priority(r), t.name(r), ownerRank[t.ownerId(r)], s);
+                });
+                break;
+            case SortKey::Name:
+                sortBy([&](const TaskStore& t, size_t r, size_t s) {
+                    return std::tuple(t.name(r), t.priority(r), t.dueDay(r), ownerRank[t.ownerId(r)], s);
+                });
+                break;
+            case SortKey::Owner:
+                sortBy([&](const TaskStore& t, size_t r, size_t s) {
+                    return std::tuple(ownerRank[t.ownerId(r)], t.priority(r), t.dueDay(r), t.name(r), s);
+                });
+                break;
+            default:
+                break;
+        }
+    }
+
+    const SortedView& sortedView(SortKey key) {
+        SortedView& view = sortedViews[size_t(key)];
+        if (view.generation == indexGeneration) return view;
+
+        view.order.clear();
+        view.order.reserve(getTaskCount());
+        for (size_t slot = 0; slot < tasks.size(); ++slot) {
+            if (!tasks.deleted(slot)) view.order.push_back(slot);
+        }
+        std::vector<uint32_t> owners;
+        for (const auto& entry : ownerSlots) owners.push_back(entry.first);
+        sortSlots(key, view.order, ownerRanks(owners), [this](size_t slot) { return liveRow(slot); });
+
+        view.rank.assign(tasks.size(), std::numeric_limits<uint32_t>::max());
+        for (size_t i = 0; i < view.order.size(); ++i) view.rank[view.order[i]] = uint32_t(i);
+        view.generation = indexGeneration;
+        return view;
+    }
+
+    // Puts distinct live slots into the current display order.
+    void applyViewOrder(std::vector<size_t>& slots) {
+        if (viewKey == SortKey::Storage) return;
+        const SortedView& view = sortedView(viewKey);
+        if (slots.size() == view.order.size()) {
+            slots = view.order;
+            return;
+        }
+        std::sort(slots.begin(), slots.end(), [&view](size_t a, size_t b) { return view.rank[a] < view.rank[b]; });
+    }
+
+    // Indexes only; the done flag itself stays in the store.
+    void indexSecondary(size_t slot) {
+        ++indexGeneration;
+        markChunkDirty(slot);
+        insertSlot(ownerSlots[tasks.ownerId(slot)], slot);
+        insertSlot(categorySlots[tasks.categoryId(slot)], slot);
+        setDoneBit(slot, tasks.done(slot));
+        adjustProgress(slot, 1, tasks.done(slot));
+        trackDue(slot);
+        for (uint32_t trigram : taskTrigrams(slot)) {
+            insertSlot(trigramSlots[trigram], slot);
+        }
+    }
+
+    void unindexSecondary(size_t slot) {
+        ++indexGeneration;
+        markChunkDirty(slot);
+        eraseSlot(ownerSlots, tasks.ownerId(slot), slot);
+        eraseSlot(categorySlots, tasks.categoryId(slot), slot);
+        setDoneBit(slot, false);
+        adjustProgress(slot, -1, -int(tasks.done(slot)));
+        untrackDue(slot);
+        for (uint32_t trigram : taskTrigrams(slot)) {
+            eraseSlot(trigramSlots, trigram, slot);
+        }
+    }
+
+    static uint64_t taskKey(uint32_t ownerId, int id) {
+        return uint64_t(ownerId) << 32 | uint32_t(id);
+    }
+
+    void indexTask(size_t slot) {
+        slotIndex[taskKey(tasks.ownerId(slot), tasks.id(slot))] = slot;
+        indexSecondary(slot);
+    }
+
+    void rebuildIndex() {
+        ++indexGeneration;
+        dirtyChunks.assign(dirtyChunks.size(), true);
+        slotIndex.clear();
+        ownerSlots.clear();
+        categorySlots.clear();
+        doneBits.assign((tasks.size() + 63) / 64, 0);
+        dueHeap = {};
+        overdueSlots.clear();
+        overallProgress = Progress();
+        ownerProgress.clear();
+        categoryProgress.clear();
+        ownerCategoryProgress.clear();
+        trigramSlots.clear();
+        for (size_t slot = 0; slot < tasks.size(); ++slot) {
+            if (!tasks.deleted(slot)) indexTask(slot);
+        }
+    }
+
+    void clearTasks() {
+        tasks.clear();
+        deletedCount = 0;
+        rebuildIndex();
+    }
+
+    static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
+    size_t findSlot(uint32_t ownerId, int id) const {
+        auto it = slotIndex.find(taskKey(ownerId, id));
+        return it == slotIndex.end() ? NO_SLOT : it->second;
+    }
+
+    void retireSlot(size_t slot) {
+        unindexSecondary(slot);
+        slotIndex.erase(taskKey(tasks.ownerId(slot), tasks.id(slot)));
+        tasks.setDeleted(slot);
+        ++deletedCount;
+    }
+
+    void compactIfSparse() {
+        if (deletedCount >= MIN_COMPACT_TOMBSTONES && deletedCount * 2 >= tasks.size()) compactTasks();
+    }
+
+    void removeTask(size_t slot) {
+        retireSlot(slot);
+        compactIfSparse();
+    }
+
+    void compactTasks() {
+        if (deletedCount == 0) return;
+        tasks.compact();
+        deletedCount = 0;
+        rebuildIndex();
+    }
+
+    std::string getTaskFileName(const std::string& user = "") {
+        std::string sanitizedUser = user.empty() ? currentUser : user;
+        std::replace(sanitizedUser.begin(), sanitizedUser.end(), ' ', '_');
+        return "tasks_" + sanitizedUser + ".txt";
+    }
+
+    std::string getLockFileName(const std::string& user = "") { return taskLockFileName(getTaskFileName(user)); }
+
+    // Live slots stored in `ownerId`'s file, in storage order. A user session only ever
+    // loads that user's file, so everything it holds goes back there.
+    std::vector<size_t> snapshotSlots(uint32_t ownerId) const {
+        if (isAdmin) {
+            auto it = ownerSlots.find(ownerId);
+            return it == ownerSlots.end() ? std::vector<size_t>() : it->second;
+        }
+        std::vector<size_t> slots;
+        slots.reserve(getTaskCount());
+        for (size_t slot = 0; slot < tasks.size(); ++slot) {
+            if (!tasks.deleted(slot)) slots.push_back(slot);
+        }
+        return slots;
+    }
+
+    void saveToFile(const std::string& user = "") {
+        MetricTimer timer(Metrics::SaveSnapshot);
+        std::string owner = user.empty() ? currentUser : user;
+        writeTaskSnapshot(getTaskFileName(owner), tasks, snapshotSlots(internSymbol(owner)), configuredSnapshotFormat());
+    }
+
+    // Mutations append a one-line record to tasks_<user>.journal instead of rewriting the
+    // whole task file; the journal is folded back into the snapshot once it grows large.
+    static constexpr size_t JOURNAL_MIN_COMPACT = 256;
+    size_t journalRecords = 0;
+    size_t snapshotTaskCount = 0;
+
+    std::string getJournalFileName(const std::string& user = "") {
+        std::string fileName = getTaskFileName(user);
+        return fileName.substr(0, fileName.size() - 4) + ".journal";
+    }
+
+    // Batch runs defer journal writes: records collect in pendingJournal and reach the
+    // file in a single append whenever flushJournal() is called.
+    bool deferJournal = false;
+    std::string pendingJournal;
+
+    void appendJournal(const std::string& record) { appendJournalRecords(record + "\n", 1); }
+
+    // `records` holds `count` newline-terminated records.
+    void appendJournalRecords(const std::string& records, size_t count) {
+        if (deferJournal) {
+            pendingJournal += records;
+            journalRecords += count;
+            return;
+        }
+        if (!writeJournal(records)) return;
+        journalRecords += count;
+        compactJournalIfLarge();
+    }
+
+    // Appends to another owner's journal and queues that owner's compaction; the caller
+    // holds the owner's lock. Falls back to writing the snapshot at once, as writeJournal() does.
+    void appendOwnerJournal(uint32_t ownerId, const std::string& records) {
+        std::string fileName = getJournalFileName(symbolName(ownerId));
+        std::ofstream outFile(fileName, std::ios::app);
+        if (!outFile.is_open()) {
+            std::cout << RED << "[ERROR] Cannot open journal for writing: " << fileName << RESET << std::endl;
+            writeOwnerSnapshot(ownerId);
+            return;
+        }
+        outFile << records;
+        outFile.close();
+        Metrics::instance().bytesWritten += records.size();
+        queueCompaction(ownerId);
+    }
+
+    // Falls back to a full snapshot when the journal cannot be appended to.
+    bool writeJournal(const std::string& records) {
+        MetricTimer timer(Metrics::JournalWrite);
+        std::string fileName = getJournalFileName();
+        std::ofstream outFile(fileName, std::ios::app);
+        if (!outFile.is_open()) {
+            std::cout << RED << "[ERROR] Cannot open journal for writing: " << fileName << RESET << std::endl;
+            compactJournal();
+            return false;
+        }
+        outFile << records;
+        outFile.close();
+        journalStamp = stampOf(fileName);
+        Metrics::instance().bytesWritten += records.size();
+        return true;
+    }
+
+    void compactJournalIfLarge() {
+        if (journalRecords >= std::max(JOURNAL_MIN_COMPACT, snapshotTaskCount / 2)) {
+            queueCompaction();
+        }
+    }
+
+    // Compactions are written behind by SnapshotWriter; writesQueued numbers this
+    // session's requests so flushJournal() can wait for them.
+    std::shared_ptr<SnapshotWriter::Session> writeBehind = std::make_shared<SnapshotWriter::Session>();
+    uint64_t writesQueued = 0;
+
+    // Another owner's files are stamped as they are now, so the caller holds their lock.
+    void queueCompaction(std::optional<uint32_t> owner = std::nullopt) {
+        uint32_t ownerId = owner.value_or(currentUserId);
+        bool own = ownerId == currentUserId;
+        const std::string& name = symbolName(ownerId);
+        SnapshotWriter::Request request;
+        request.session = writeBehind;
+        request.sequence = ++writesQueued;
+        request.snapshot = currentSnapshot();
+        if (isAdmin) request.ownerId = ownerId;
+        request.snapshotFile = getTaskFileName(name);
+        request.journalFile = getJournalFileName(name);
+        request.format = configuredSnapshotFormat();
+        request.expectedSnapshot = own ? snapshotStamp : stampOf(request.snapshotFile);
+        request.coveredJournal = own ? journalStamp : stampOf(request.journalFile);
+        SnapshotWriter::instance().submit(std::move(request));
+        if (!own) return;
+        journalRecords = 0;
+        snapshotTaskCount = getTaskCount();
+    }
+
+    // Takes over the file stamps of finished background writes and reports their errors.
+    void absorbWrites() {
+        std::lock_guard guard(writeBehind->guard);
+        for (const SnapshotWriter::Session::Result& result : writeBehind->results) {
+            if (result.snapshotFile != taskFileName) continue;  // another owner's, written for admin
+            if (snapshotStamp == result.snapshotBefore) snapshotStamp = result.snapshotAfter;
+            if (result.journalTrimmed && journalStamp == result.journalBefore) journalStamp = result.journalAfter;
+        }
+        writeBehind->results.clear();
+        std::cout << writeBehind->log;
+        writeBehind->log.clear();
+    }
+
+    // Writes the snapshot now, for when the journal itself cannot be written. Our own
+    // files are already locked by the change being written.
+    void compactJournal() {
+        FileLock lock;
+        if (!changeLock.held()) lock.lock(getLockFileName(), FileLock::Exclusive);
+        writeOwnerSnapshot(currentUserId);
+    }
+
+    // Rewrites an owner's snapshot and truncates their journal. Replaying a journal on top
+    // of a snapshot that already contains its records is harmless (records carry full task
+    // state), so a crash between the two steps loses nothing. Callers hold the owner's lock.
+    void writeOwnerSnapshot(uint32_t ownerId) {
+        const std::string& owner = symbolName(ownerId);
+        saveToFile(owner);
+        std::ofstream(getJournalFileName(owner), std::ios::trunc).close();
+        if (ownerId == currentUserId) {
+            pendingJournal.clear();  // the snapshot covers them
+            journalRecords = 0;
+            snapshotTaskCount = getTaskCount();
+            snapshotStamp = stampOf(getTaskFileName());
+            journalStamp = stampOf(getJournalFileName());
+        }
+    }
+
+    // Other processes may write the same files. Each change to this session's own files
+    // runs under its lock, and first reloads them if they changed since we last read or
+    // wrote them, so neither side's updates are lost. A deferred batch keeps the lock from
+    // its first change until flushJournal() has written everything.
+    FileLock changeLock;
+    FileStamp snapshotStamp, journalStamp;
+
+    class ChangeScope {
+    private:
+        ToDoList& list;
+
+    public:
+        explicit ChangeScope(ToDoList& changed) : list(changed) { list.beginChange(); }
+        ~ChangeScope() {
+            if (!list.deferJournal) list.changeLock.unlock();
+        }
+
+        ChangeScope(const ChangeScope&) = delete;
+        ChangeScope& operator=(const ChangeScope&) = delete;
+    };
+
+    void beginChange() {
+        if (changeLock.held()) return;
+        changeLock.lock(getLockFileName(), FileLock::Exclusive);
+        absorbWrites();
+        if (stampOf(getTaskFileName()) == snapshotStamp && stampOf(getJournalFileName()) == journalStamp) return;
+        reloadOwner(currentUserId);
+        std::cout << YELLOW << "[INFO] Reloaded tasks changed by another session." << RESET << std::endl;
+    }
+
+    // Replaces an owner's tasks with what is on disk now. Callers hold the owner's lock.
+    void reloadOwner(uint32_t ownerId) {
+        auto it = ownerSlots.find(ownerId);
+        if (it != ownerSlots.end()) {
+            std::vector<size_t> slots = it->second;
+            for (size_t slot : slots) retireSlot(slot);
+        }
+        compactIfSparse();
+        const std::string& owner = symbolName(ownerId);
+        UserTaskLoad loaded = loadUserTasks(getTaskFileName(owner), getJournalFileName(owner), owner);
+        if (loaded.hasSnapshot || loaded.hasJournal) {
+            loaded.log.clear();  // already reported when the session started
+            mergeLoadedTasks(loaded, owner);
+        } else if (ownerId == currentUserId) {
+            snapshotStamp = journalStamp = FileStamp();
+            snapshotTaskCount = journalRecords = 0;
+        }
+        publishSnapshot();
+    }
+
+    // Appends a freshly loaded user's tasks to the store and indexes them.
+    void mergeLoadedTasks(UserTaskLoad& loaded, const std::string& user) {
+        std::cout << loaded.log;
+        std::string owner = user.empty() ? currentUser : user;
+        if (owner == currentUser) {
+            snapshotStamp = loaded.snapshotStamp;
+            journalStamp = loaded.journalStamp;
+        }
+        if (!loaded.hasSnapshot && !loaded.hasJournal) {
+            std::cout << YELLOW << "[INFO] No task file found for user: " << owner << RESET << std::endl;
+            return;
+        }
+
+        tasks.reserve(tasks.size() + loaded.tasks.size());
+        for (const Task& task : loaded.tasks) {
+            nextId = std::max(nextId, task.id + 1);
+            indexTask(tasks.push_back(task));
+        }
+        loaded.tasks = std::vector<Task>();
+        if (user.empty() || user == currentUser) {
+            snapshotTaskCount = loaded.snapshotCount;
+            journalRecords = loaded.journalRecords;
+        }
+    }
+
+    void loadFromFile(const std::string& user = "") {
+        MetricTimer timer(Metrics::LoadUser);
+        if (user.empty() && !isAdmin) {
+            clearTasks();
+            nextId = 1;
+        }
+        FileLock lock(getLockFileName(user), FileLock::Shared);
+        UserTaskLoad loaded = loadUserTasks(getTaskFileName(user), getJournalFileName(user),
+                                            user.empty() ? currentUser : user);
+        mergeLoadedTasks(loaded, user);
+    }
+
+    void loadAllUsersTasks() {
+        MetricTimer timer(Metrics::LoadAllUsers);
+        clearTasks();
+        nextId = 1;
+        // A user who has only ever appended to their journal has no snapshot yet.
+        std::vector<std::string> users;
+        for (const auto& entry : std::filesystem::directory_iterator(".")) {
+            std::string fileName = entry.path().filename().string();
+            if (fileName.find("tasks_") != 0) continue;
+            if (fileName.ends_with(".txt")) {
+                users.push_back(fileName.substr(6, fileName.size() - 10));
+            } else if (fileName.ends_with(".journal")) {
+                users.push_back(fileName.substr(6, fileName.size() - 14));
+            }
+        }
+        std::sort(users.begin(), users.end());
+        users.erase(std::unique(users.begin(), users.end()), users.end());
+
+        // File names replace spaces with '_'; older journal records only know the owner
+        // from the file, so map each name back to the registered user it belongs to.
+        std::unordered_map<std::string, std::string> registered;
+        for (const std::string& name : UserDirectory::instance().list()) registered.emplace(getTaskFileName(name), name);
+        for (std::string& user : users) {
+            auto it = registered.find(getTaskFileName(user));
+            if (it != registered.end()) user = it->second;
+        }
+
+        // Parse the files on a pool of at most one worker per core, each into its own
+        // buffer, then merge on this thread in user order so slots are deterministic.
+        std::vector<UserTaskLoad> loaded(users.size());
+        std::vector<std::pair<std::string, std::string>> fileNames;
+        for (const auto& user : users) {
+            fileNames.emplace_back(getTaskFileName(user), getJournalFileName(user));
+        }
+        std::atomic<size_t> nextUser{0};
+        auto worker = [&] {
+            for (size_t i; (i = nextUser.fetch_add(1)) < users.size();) {
+                FileLock lock(taskLockFileName(fileNames[i].first), FileLock::Shared);
+                loaded[i] = loadUserTasks(fileNames[i].first, fileNames[i].second, users[i]);
+            }
+        };
+        size_t workerCount = std::min<size_t>(users.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& workerThread : workers) {
+            workerThread.join();
+        }
+
+        size_t total = 0;
+        for (const auto& result : loaded) {
+            total += result.tasks.size();
+        }
+        tasks.reserve(total);
+        for (size_t i = 0; i < users.size(); ++i) {
+            mergeLoadedTasks(loaded[i], users[i]);
+        }
+        if (users.empty()) {
+            std::cout << YELLOW << "[INFO] No task files found in directory." << RESET << std::endl;
+        }
+    }
+
+    size_t pageSize = 0;  // rows between "more" prompts; 0 prints listings in one go
+
+    // Prints rows [offset, offset + limit) of `slots` as a table, stopping after every
+    // page until the user asks for more.
+    void renderTaskTable(const std::vector<size_t>& slots, int today, size_t offset = 0, size_t limit = 0) {
+        MetricTimer timer(Metrics::Render);
+        size_t end = limit ? std::min(slots.size(), offset + limit) : slots.size();
+        TaskTableRenderer table(isAdmin);
+        table.header();
+        for (size_t i = offset; i < end; ++i) {
+            table.row(tasks, slots[i], today);
+            size_t shown = i + 1 - offset;
+            if (pageSize && shown % pageSize == 0 && i + 1 < end) {
+                table.flush();
+                std::cout << BLUE << "-- " << shown << " of " << end - offset << " rows, Enter for more or q to stop: " << RESET;
+                std::string answer;
+                if (!std::getline(std::cin, answer) || answer == "q" || answer == "Q") break;
+            }
+        }
+        table.footer();
+        table.flush();
+        if (offset > 0 || end < slots.size()) {
+            std::cout << BLUE << "Rows " << offset + 1 << "-" << end << " of " << slots.size() << RESET << "\n";
+        }
+    }
+
+public:
+    // Loads the session's tasks without rendering anything that could page; callers show
+    // the overdue warning with checkOverdueTasks() once they have set the page size.
+    ToDoList(const std::string& user, bool admin = false)
+        : currentUser(user), currentUserId(internSymbol(user)), isAdmin(admin), nextId(1) {
+        taskFileName = getTaskFileName();
+        pageSize = stdinIsTerminal() ? configuredPageSize() : 0;
+        if (isAdmin) {
+            loadAllUsersTasks();
+        } else {
+            loadFromFile();
+        }
+        publishSnapshot();  // copies the store once, so later changes copy single chunks
+    }
+
+    ~ToDoList() { flushJournal(); }
+
+    ToDoList(const ToDoList&) = delete;
+    ToDoList& operator=(const ToDoList&) = delete;
+
+    // While deferred, mutations are kept in memory until the next flushJournal().
+    void setDeferredJournal(bool defer) {
+        if (!defer) flushJournal();
+        deferJournal = defer;
+    }
+
+    void flushJournal() {
+        if (!pendingJournal.empty()) {
+            std::string records;
+            records.swap(pendingJournal);
+            if (writeJournal(records)) compactJournalIfLarge();
+        }
+        changeLock.unlock();  // held since the first deferred change
+        SnapshotWriter::waitFor(*writeBehind, writesQueued);
+        absorbWrites();
+    }
+
+    // Non-interactive callers turn paging off even when stdin happens to be a terminal.
+    void setPageSize(size_t rows) { pageSize = rows; }
+
+    // Re-reads one owner's tasks after another session changed them.
+    void reloadOwnerTasks(const std::string& owner) {
+        uint32_t ownerId = internSymbol(owner);
+        FileLock lock(getLockFileName(owner), FileLock::Shared);
+        reloadOwner(ownerId);
+    }
+
+    // The latest published version. Safe from any thread.
+    std::shared_ptr<const TaskSnapshot> snapshot() const { return published.load(); }
+
+    size_t getTaskCount() const { return tasks.size() - deletedCount; }
+    bool getIsAdmin() const { return isAdmin; }
+    std::string getCurrentUser() const { return currentUser; }
+
+    void addTask(const std::string& name, int priority, const std::string& dueDate, const std::string& category = "General") {
+        MetricTimer timer(Metrics::AddTask);
+        ChangeScope change(*this);
+        if (name.empty()) {
+            std::cout << RED << "[ERROR] Task name cannot be empty." << RESET << std::endl;
+            return;
+        }
+        if (!isValidPriority(priority)) {
+            std::cout << RED << "[ERROR] Priority must be between 1 and 5." << RESET << std::endl;
+            return;
+        }
+        Date date = Date::fromString(dueDate);
+        if (!date.isValid()) {
+            std::cout << RED << "[ERROR] Invalid due date format. Use DD-MM-YYYY." << RESET << std::endl;
+            return;
+        }
+
+        Task task(nextId++, name, priority, date.toDays(), false, category, currentUser);
+        indexTask(tasks.push_back(task));
+        appendJournal(journalTaskRecord('A', task));
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Task added successfully." << RESET << std::endl;
+    }
+
+    void editTask(int id, const std::string& name, int priority, const std::string& dueDate, const std::string& category) {
+        MetricTimer timer(Metrics::EditTask);
+        ChangeScope change(*this);
+        size_t slot = findSlot(currentUserId, id);
+        if (slot == NO_SLOT) {
+            std::cout << RED << "[ERROR] Task not found or you lack permission." << RESET << std::endl;
+            return;
+        }
+        Date date = Date::fromString(dueDate);
+        bool changeDueDate = !dueDate.empty() && dueDate != "01-01-1970";
+        if (changeDueDate && !date.isValid()) {
+            std::cout << RED << "[ERROR] Invalid due date format. Use DD-MM-YYYY." << RESET << std::endl;
+            return;
+        }
+
+        unindexSecondary(slot);
+        if (!name.empty()) tasks.setName(slot, name);
+        if (isValidPriority(priority)) tasks.setPriority(slot, priority);
+        if (changeDueDate) tasks.setDueDay(slot, date.toDays());
+        if (!category.empty()) tasks.setCategoryId(slot, internSymbol(category));
+        indexSecondary(slot);
+        appendJournal(journalTaskRecord('E', tasks.get(slot)));
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Task ID " << id << " updated successfully." << RESET << std::endl;
+    }
+
+    void checkOverdueTasks() {
+        int today = Date::today();
+        advanceOverdue(today);
+
+        std::vector<size_t> overdueTasks;
+        for (const DueEntry& entry : overdueSlots) {
+            if (isAdmin || tasks.ownerId(entry.second) == currentUserId) overdueTasks.push_back(entry.second);
+        }
+
+        if (!overdueTasks.empty()) {
+            std::cout << YELLOW << "\n[WARNING] You have " << overdueTasks.size() << " overdue task(s):" << RESET << std::endl;
+            renderTaskTable(overdueTasks, today);
+        }
+    }
+
+    void markAsDoneById(int id) {
+        MetricTimer timer(Metrics::MarkDone);
+        ChangeScope change(*this);
+        size_t slot = findSlot(currentUserId, id);
+        if (slot == NO_SLOT || tasks.done(slot)) {
+            std::cout << RED << "[ERROR] Task not found, already done, or you lack permission." << RESET << std::endl;
+            return;
+        }
+        setDone(slot, true);
+        appendJournal("D\t" + std::to_string(id));
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Task ID " << id << " marked as done." << RESET << std::endl;
+    }
+
+    void unmarkTaskById(int id) {
+        MetricTimer timer(Metrics::UnmarkDone);
+        ChangeScope change(*this);
+        size_t slot = findSlot(currentUserId, id);
+        if (slot == NO_SLOT || !tasks.done(slot)) {
+            std::cout << RED << "[ERROR] Task not found, not done, or you lack permission." << RESET << std::endl;
+            return;
+        }
+        setDone(slot, false);
+        appendJournal("U\t" + std::to_string(id));
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Task ID " << id << " unmarked as done." << RESET << std::endl;
+    }
+
+    void deleteTaskById(int id) {
+        MetricTimer timer(Metrics::DeleteTask);
+        ChangeScope change(*this);
+        size_t slot = findSlot(currentUserId, id);
+        if (slot == NO_SLOT) {
+            std::cout << RED << "[ERROR] Task not found or you lack permission." << RESET << std::endl;
+            return;
+        }
+        removeTask(slot);
+        appendJournal("X\t" + std::to_string(id));
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Task deleted successfully." << RESET << std::endl;
+    }
+
+    // Asks for confirmation on stdin unless the caller has already confirmed.
+    void clearAllTask(bool confirmed = false) {
+        char response = 'Y';
+        if (!confirmed) {
+            std::cout << YELLOW << "[WARNING] Are you sure? [Y/N]: " << RESET;
+            std::cin >> response;
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Clear input buffer
+        }
+
+        if (toupper(response) == 'Y') {
+            ChangeScope change(*this);
+            clearTasks();
+            nextId = 1;
+            appendJournal("C");  // admin clears only its own file, as it always has
+            if (!deferJournal) queueCompaction();
+            publishSnapshot();
+            std::cout << GREEN << "[SUCCESS] All tasks have been cleared successfully!" << RESET << std::endl;
+        } else {
+            std::cout << RED << "[FAILED] Cancel the process" << std::endl;
+        }
+    }
+
+    // Changes the display order only; storage and the saved files keep insertion order.
+    void sortTasks(const std::string& criterion) {
+        MetricTimer timer(Metrics::SortTasks);
+        SortKey key;
+        if (!parseSortKey(criterion, key)) {
+            std::cout << RED << "[ERROR] Invalid sort criterion. Use 'priority', 'date', 'name'"
+                 << (isAdmin ? ", or 'owner'." : ".") << RESET << std::endl;
+            return;
+        }
+        viewKey = key;
+        sortedView(key);  // build it now rather than on the next listing
+        std::cout << GREEN << "[INFO] Tasks sorted by " << criterion << "." << RESET << std::endl;
+    }
+
+    // Slots of live tasks visible to this session that pass every filter, in storage order.
+    // Owner and category filters come from their slot lists (intersected smallest first)
+    // and the status filter from the done bitset, so cost follows the most selective filter.
+    std::vector<size_t> matchingSlots(const std::string& filter, const std::string& category, const std::string& owner) {
+        static const std::vector<size_t> noSlots;
+        // A string that was never interned cannot belong to any task.
+        auto lookup = [](const std::unordered_map<uint32_t, std::vector<size_t>>& index, const std::string& key) {
+            uint32_t id;
+            if (!SymbolTable::instance().find(key, id)) return &noSlots;
+            auto it = index.find(id);
+            return it == index.end() ? &noSlots : &it->second;
+        };
+
+        std::vector<const std::vector<size_t>*> lists;
+        if (!isAdmin && !owner.empty() && owner != currentUser) return {};
+        if (!isAdmin || !owner.empty()) lists.push_back(lookup(ownerSlots, isAdmin ? owner : currentUser));
+        if (!category.empty()) lists.push_back(lookup(categorySlots, category));
+        std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+            return a->size() < b->size();
+        });
+
+        bool wantDone = filter == "completed", wantOpen = filter == "incomplete";
+        auto statusMatches = [&](size_t slot) {
+            return (!wantDone && !wantOpen) || isDoneSlot(slot) == wantDone;
+        };
+
+        std::vector<size_t> result;
+        if (lists.empty()) {
+            if (wantDone) {
+                for (size_t word = 0; word < doneBits.size(); ++word) {
+                    for (uint64_t bits = doneBits[word]; bits; bits &= bits - 1) {
+                        result.push_back(word * 64 + std::countr_zero(bits));
+                    }
+                }
+            } else {
+                for (size_t slot = 0; slot < tasks.size(); ++slot) {
+                    if (!tasks.deleted(slot) && statusMatches(slot)) result.push_back(slot);
+                }
+            }
+            return result;
+        }
+
+        for (size_t slot : *lists[0]) {
+            if (statusMatches(slot)) result.push_back(slot);
+        }
+        for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+            std::vector<size_t> narrowed;
+            std::set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(),
+                             std::back_inserter(narrowed));
+            result.swap(narrowed);
+        }
+        return result;
+    }
+
+    // `offset`/`limit` select a window of the matching rows; a limit of 0 means all of them.
+    // Reads the live store, not a snapshot: callers serialise it with mutations, or use
+    // snapshotListing() from another thread.
+    void showTasks(const std::string& filter = "all", const std::string& category = "", const std::string& owner = "",
+                   size_t offset = 0, size_t limit = 0) {
+        std::vector<size_t> filteredSlots = matchingSlots(filter, category, owner);
+
+        if (offset >= filteredSlots.size()) {
+            std::cout << YELLOW << "[INFO] No tasks to show." << RESET << std::endl;
+            return;
+        }
+
+        applyViewOrder(filteredSlots);
+        std::cout << "\n";
+        renderTaskTable(filteredSlots, Date::today(), offset, limit);
+        printProgress("Progress", isAdmin ? overallProgress : findProgress(ownerProgress, currentUserId));
+
+        // The category breakdown follows the listing's owner scope.
+        uint32_t categoryId, ownerId;
+        if (category.empty() || !SymbolTable::instance().find(category, categoryId)) return;
+        if (!isAdmin) ownerId = currentUserId;
+        else if (owner.empty() || !SymbolTable::instance().find(owner, ownerId)) {
+            printProgress("Category '" + category + "'", findProgress(categoryProgress, categoryId));
+            return;
+        }
+        printProgress("Category '" + category + "'",
+                      findProgress(ownerCategoryProgress, uint64_t(ownerId) << 32 | categoryId));
+    }
+
+    // Slots of visible tasks whose name or category contains `query` (case-insensitive).
+    // Like showTasks(), this reads the live store and its indexes.
+    std::vector<size_t> searchSlots(const std::string& query, const std::string& owner) {
+        MetricTimer timer(Metrics::Search);
+        std::string queryLower = toLower(query);
+        std::vector<uint32_t> trigrams;
+        collectTrigrams(queryLower, trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+        // Queries shorter than a trigram can only be answered by checking each visible task.
+        std::vector<size_t> candidates;
+        if (trigrams.empty()) {
+            candidates = matchingSlots("all", "", owner);
+        } else {
+            std::vector<const std::vector<size_t>*> lists;
+            for (uint32_t trigram : trigrams) {
+                auto it = trigramSlots.find(trigram);
+                if (it == trigramSlots.end()) return {};
+                lists.push_back(&it->second);
+            }
+            std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+                return a->size() < b->size();
+            });
+            candidates = *lists[0];
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                std::vector<size_t> narrowed;
+                std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                                 std::back_inserter(narrowed));
+                candidates.swap(narrowed);
+            }
+        }
+
+        // An owner that was never interned cannot own any task.
+        uint32_t ownerId = 0;
+        if (!owner.empty() && !SymbolTable::instance().find(owner, ownerId)) return {};
+
+        std::vector<size_t> results;
+        for (size_t slot : candidates) {
+            if ((isAdmin || tasks.ownerId(slot) == currentUserId) && (owner.empty() || tasks.ownerId(slot) == ownerId) &&
+                matchesQuery(tasks, slot, queryLower)) {
+                results.push_back(slot);
+            }
+        }
+        return results;
+    }
+
+    void searchTasks(const std::string& query, const std::string& owner = "", size_t offset = 0, size_t limit = 0) {
+        std::vector<size_t> results = searchSlots(query, owner);
+
+        if (offset >= results.size()) {
+            std::cout << YELLOW << "[INFO] No tasks match the query '" << query << "'." << RESET << std::endl;
+            return;
+        }
+
+        applyViewOrder(results);
+        std::cout << "\n";
+        renderTaskTable(results, Date::today(), offset, limit);
+    }
+
+    // Each priority step weighs as much as a week of due-date slack, so a priority-1 task due
+    // in ten days outranks a priority-3 task due tomorrow.
+    static constexpr int URGENCY_DAYS_PER_PRIORITY = 7;
+
+    // The `count` most urgent visible tasks that pass the filters, most urgent first. Only
+    // the winners get ordered, and storage is left as it is.
+    std::vector<size_t> mostUrgentSlots(size_t count, const std::string& filter, const std::string& category, const std::string& owner) {
+        std::vector<size_t> candidates = matchingSlots(filter, category, owner);
+        keepMostUrgent(candidates, count, [this](size_t slot) { return liveRow(slot); });
+        return candidates;
+    }
+
+    // Cuts `slots` down to the `count` most urgent, most urgent first; `at(slot)` gives the
+    // row a slot refers to.
+    template <typename At>
+    static void keepMostUrgent(std::vector<size_t>& slots, size_t count, At at) {
+        auto urgency = [&at](size_t slot) {
+            auto [rows, row] = at(slot);
+            return std::tuple(rows.dueDay(row) + (rows.priority(row) - 1) * URGENCY_DAYS_PER_PRIORITY,
+                              rows.priority(row), rows.dueDay(row), slot);
+        };
+        count = std::min(count, slots.size());
+        std::partial_sort(slots.begin(), slots.begin() + count, slots.end(),
+                     [&urgency](size_t a, size_t b) { return urgency(a) < urgency(b); });
+        slots.resize(count);
+    }
+
+    void showMostUrgent(size_t count = 10, const std::string& filter = "incomplete", const std::string& category = "",
+                        const std::string& owner = "") {
+        std::vector<size_t> slots = mostUrgentSlots(count, filter, category, owner);
+        if (slots.empty()) {
+            std::cout << YELLOW << "[INFO] No tasks to show." << RESET << std::endl;
+            return;
+        }
+
+        std::cout << "\n";
+        renderTaskTable(slots, Date::today());
+    }
+
+    // Adds every valid task in a CSV or JSON Lines file under fresh ids, journalling them in
+    // one append per affected user. Admin imports take the owner from each record and skip
+    // records without one; users import into their own list. Each owner's file is re-read
+    // under its lock first, so changes made elsewhere survive.
+    void importTasks(const std::string& fileName, const std::string& formatName = "") {
+        MetricTimer timer(Metrics::Import);
+        ExchangeFormat format;
+        if (!parseExchangeFormat(fileName, formatName, format)) {
+            std::cout << RED << "[ERROR] Unknown import format. Use a .csv or .jsonl file, or name the format." << RESET << std::endl;
+            return;
+        }
+        std::ifstream inFile(fileName, std::ios::binary);
+        if (!inFile.is_open()) {
+            std::cout << RED << "[ERROR] Cannot open file for reading: " << fileName << RESET << std::endl;
+            return;
+        }
+
+        uint32_t noOwner = internSymbol("");
+        std::map<uint32_t, std::vector<Task>> incoming;  // by owner
+        size_t imported = 0, skipped = 0;
+        bool readable = readImportFile(inFile, format, fileName, [&](Task& task) {
+            if (!isAdmin) task.ownerId = currentUserId;
+            else if (task.ownerId == noOwner) return false;
+            incoming[task.ownerId].push_back(task);
+            ++imported;
+            return true;
+        }, skipped, std::cout);
+        if (!readable) return;
+
+        // The snapshots catch up in the background, as after any other add.
+        auto append = [&](std::vector<Task>& ownerTasks) {
+            std::string records;
+            for (Task& task : ownerTasks) {
+                task.id = nextId++;
+                indexTask(tasks.push_back(task));
+                records += journalTaskRecord('A', task);
+                records += '\n';
+            }
+            return records;
+        };
+        for (auto& [ownerId, ownerTasks] : incoming) {
+            if (ownerId == currentUserId) {
+                ChangeScope change(*this);
+                appendJournalRecords(append(ownerTasks), ownerTasks.size());
+                continue;
+            }
+            // Another user's tasks are merged with their current file under their lock.
+            FileLock lock(getLockFileName(symbolName(ownerId)), FileLock::Exclusive);
+            reloadOwner(ownerId);
+            appendOwnerJournal(ownerId, append(ownerTasks));
+        }
+        publishSnapshot();
+        std::cout << GREEN << "[INFO] Imported " << imported << " task(s) from " << fileName;
+        if (skipped > 0) std::cout << " (" << skipped << " skipped)";
+        std::cout << "." << RESET << std::endl;
+    }
+
+    // An export of the current snapshot that can run on another thread while this list
+    // keeps changing. Returns an empty job after reporting a bad format.
+    std::function<void(std::ostream&)> snapshotExport(const std::string& fileName, const std::string& formatName = "") {
+        ExchangeFormat format;
+        if (!parseExchangeFormat(fileName, formatName, format)) {
+            std::cout << RED << "[ERROR] Unknown export format. Use a .csv or .jsonl file, or name the format." << RESET << std::endl;
+            return {};
+        }
+        std::optional<uint32_t> ownerId;
+        if (!isAdmin) ownerId = currentUserId;
+        return [snapshot = currentSnapshot(), ownerId, fileName, format](std::ostream& log) {
+            exportSnapshot(*snapshot, ownerId, fileName, format, log);
+        };
+    }
+
+private:
+    // Filters for a snapshot query, resolved on the owning thread so the job never touches
+    // the list. `none` marks a filter that names an owner or category no task can have.
+    struct SnapshotFilter {
+        std::optional<uint32_t> ownerId, categoryId;
+        bool wantDone = false, wantOpen = false;
+        bool none = false;
+
+        bool matches(const TaskStore& rows, size_t row) const {
+            return !none && (!ownerId || rows.ownerId(row) == *ownerId) &&
+                   (!categoryId || rows.categoryId(row) == *categoryId) &&
+                   ((!wantDone && !wantOpen) || rows.done(row) == wantDone);
+        }
+    };
+
+    // The same visibility and filters as matchingSlots().
+    SnapshotFilter snapshotFilter(const std::string& filter, const std::string& category, const std::string& owner) const {
+        SnapshotFilter result;
+        result.wantDone = filter == "completed";
+        result.wantOpen = filter == "incomplete";
+        uint32_t id;
+        if (!isAdmin) {
+            result.ownerId = currentUserId;
+            result.none = !owner.empty() && owner != currentUser;
+        } else if (!owner.empty()) {
+            if (SymbolTable::instance().find(owner, id)) result.ownerId = id;
+            else result.none = true;
+        }
+        if (!category.empty()) {
+            if (SymbolTable::instance().find(category, id)) result.categoryId = id;
+            else result.none = true;
+        }
+        return result;
+    }
+
+    // applyViewOrder() for snapshot slots, sorting just the given ones.
+    static void orderSnapshotSlots(const TaskSnapshot& snapshot, SortKey key, std::vector<size_t>& slots) {
+        if (key == SortKey::Storage) return;
+        std::vector<uint32_t> owners;
+        for (size_t slot : slots) {
+            auto [rows, row] = snapshot.at(slot);
+            owners.push_back(rows.ownerId(row));
+        }
+        std::sort(owners.begin(), owners.end());
+        owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+        sortSlots(key, slots, ownerRanks(owners), [&snapshot](size_t slot) { return snapshot.at(slot); });
+    }
+
+    // renderTaskTable() for snapshot slots, without paging.
+    static void renderSnapshotTable(const TaskSnapshot& snapshot, const std::vector<size_t>& slots, bool withOwner,
+                                    int today, size_t offset, size_t limit, std::ostream& out) {
+        MetricTimer timer(Metrics::Render);
+        size_t end = limit ? std::min(slots.size(), offset + limit) : slots.size();
+        TaskTableRenderer table(withOwner);
+        table.header();
+        for (size_t i = offset; i < end; ++i) {
+            auto [rows, row] = snapshot.at(slots[i]);
+            table.row(rows, row, today);
+        }
+        table.footer();
+        table.flush(out);
+        if (offset > 0 || end < slots.size()) {
+            out << BLUE << "Rows " << offset + 1 << "-" << end << " of " << slots.size() << RESET << "\n";
+        }
+    }
+
+public:
+    // Jobs that answer showTasks(), searchTasks() and showMostUrgent() from the current
+    // snapshot, for callers that run them on another thread while this list keeps changing.
+    // They scan the snapshot's rows instead of the indexes and print the same output.
+    using SnapshotQuery = std::function<void(std::ostream&)>;
+
+    SnapshotQuery snapshotListing(const std::string& filter, const std::string& category, const std::string& owner,
+                                  size_t offset = 0, size_t limit = 0) {
+        std::optional<uint32_t> visibleOwner;
+        if (!isAdmin) visibleOwner = currentUserId;
+        return [snapshot = currentSnapshot(), scope = snapshotFilter(filter, category, owner), visibleOwner,
+                admin = isAdmin, order = viewKey, today = Date::today(), category, offset, limit](std::ostream& out) {
+            std::vector<size_t> slots;
+            Progress overall, inCategory;
+            snapshot->forEachLiveSlot(visibleOwner, [&](const TaskStore& rows, size_t row, size_t slot) {
+                ++overall.total;
+                overall.completed += rows.done(row);
+                if (scope.categoryId && rows.categoryId(row) == *scope.categoryId &&
+                    (!scope.ownerId || rows.ownerId(row) == *scope.ownerId)) {
+                    ++inCategory.total;
+                    inCategory.completed += rows.done(row);
+                }
+                if (scope.matches(rows, row)) slots.push_back(slot);
+            });
+            if (offset >= slots.size()) {
+                out << YELLOW << "[INFO] No tasks to show." << RESET << std::endl;
+                return;
+            }
+            orderSnapshotSlots(*snapshot, order, slots);
+            out << "\n";
+            renderSnapshotTable(*snapshot, slots, admin, today, offset, limit, out);
+            printProgress("Progress", overall, out);
+            if (scope.categoryId) printProgress("Category '" + category + "'", inCategory, out);
+        };
+    }
+
+    SnapshotQuery snapshotSearch(const std::string& query, const std::string& owner = "", size_t offset = 0, size_t limit = 0) {
+        return [snapshot = currentSnapshot(), scope = snapshotFilter("all", "", owner), admin = isAdmin, order = viewKey,
+                today = Date::today(), query, offset, limit](std::ostream& out) {
+            std::vector<size_t> results;
+            {
+                MetricTimer timer(Metrics::Search);
+                std::string queryLower = toLower(query);
+                snapshot->forEachLiveSlot(scope.ownerId, [&](const TaskStore& rows, size_t row, size_t slot) {
+                    if (scope.matches(rows, row) && matchesQuery(rows, row, queryLower)) results.push_back(slot);
+                });
+            }
+            if (offset >= results.size()) {
+                out << YELLOW << "[INFO] No tasks match the query '" << query << "'." << RESET << std::endl;
+                return;
+            }
+            orderSnapshotSlots(*snapshot, order, results);
+            out << "\n";
+            renderSnapshotTable(*snapshot, results, admin, today, offset, limit, out);
+        };
+    }
+
+    SnapshotQuery snapshotUrgent(size_t count, const std::string& filter = "incomplete", const std::string& category = "",
+                                 const std::string& owner = "") {
+        return [snapshot = currentSnapshot(), scope = snapshotFilter(filter, category, owner), admin = isAdmin,
+                today = Date::today(), count](std::ostream& out) {
+            std::vector<size_t> slots;
+            snapshot->forEachLiveSlot(scope.ownerId, [&](const TaskStore& rows, size_t row, size_t slot) {
+                if (scope.matches(rows, row)) slots.push_back(slot);
+            });
+            keepMostUrgent(slots, count, [&snapshot](size_t slot) { return snapshot->at(slot); });
+            if (slots.empty()) {
+                out << YELLOW << "[INFO] No tasks to show." << RESET << std::endl;
+                return;
+            }
+            out << "\n";
+            renderSnapshotTable(*snapshot, slots, admin, today, 0, 0, out);
+        };
+    }
+
+    // Writes every task visible to this session, in storage order.
+    void exportTasks(const std::string& fileName, const std::string& formatName = "") {
+        if (auto job = snapshotExport(fileName, formatName)) job(std::cout);
+    }
+
+    void listAllUsers() {
+        UserDirectory& directory = UserDirectory::instance();
+        if (!directory.fileAvailable()) {
+            std::cout << RED << "[ERROR] Cannot open users file." << RESET << std::endl;
+            return;
+        }
+
+        std::vector<std::string> users = directory.list();
+        users.erase(std::remove(users.begin(), users.end(), "admin"), users.end());
+
+        if (users.empty()) {
+            std::cout << YELLOW << "[INFO] No users found." << RESET << std::endl;
+            return;
+        }
+
+        std::cout << "\n" << CYAN << std::string(30, '=') << RESET << "\n";
+        std::cout << CYAN << "|" << std::left << std::setw(28) << "Username" << "|" << RESET << "\n";
+        std::cout << CYAN << std::string(30, '=') << RESET << "\n";
+        for (const auto& user : users) {
+            std::cout << "|" << std::left << std::setw(28) << user << "|\n";
+        }
+        std::cout << CYAN << std::string(30, '=') << RESET << "\n";
+    }
+
+    void removeUser(const std::string& username) {
+        if (username == "admin") {
+            std::cout << RED << "[ERROR] Cannot remove the admin account." << RESET << std::endl;
+            return;
+        }
+
+        UserDirectory& directory = UserDirectory::instance();
+        if (!directory.exists(username)) {
+            std::cout << RED << "[ERROR] User '" << username << "' not found." << RESET << std::endl;
+            return;
+        }
+        if (!directory.remove(username)) {
+            return;
+        }
+
+        FileLock lock(getLockFileName(username), FileLock::Exclusive);
+        std::string taskFile = getTaskFileName(username);
+        if (std::filesystem::exists(taskFile)) {
+            std::filesystem::remove(taskFile);
+        }
+        std::string journalFile = getJournalFileName(username);
+        if (std::filesystem::exists(journalFile)) {
+            std::filesystem::remove(journalFile);
+        }
+        lock.unlock();  // the lock file stays: a waiter may already hold it open
+
+        uint32_t ownerId;
+        if (SymbolTable::instance().find(username, ownerId)) {
+            for (size_t slot = 0; slot < tasks.size(); ++slot) {
+                if (tasks.ownerId(slot) == ownerId) tasks.setDeleted(slot);
+            }
+        }
+        tasks.compact();
+        deletedCount = 0;
+        rebuildIndex();
+        publishSnapshot();
+
+        std::cout << GREEN << "[INFO] User '" << username << "' and their tasks removed successfully." << RESET << std::endl;
+    }
+};
+
+inline bool userExists(const std::string& username) {
+    return UserDirectory::instance().exists(trim(username));
+}
+
+inline bool registerUser(const std::string& username, const std::string& password) {
+    std::string trimmedUsername = trim(username);
+    std::string trimmedPassword = trim(password);
+
+    if (trimmedUsername.empty() || trimmedPassword.empty()) {
+        std::cout << RED << "[ERROR] Username and password cannot be empty." << RESET << std::endl;
+        return false;
+    }
+
+    // users.txt reads "!name" as a removal and splits records at the first comma.
+    if (trimmedUsername[0] == '!' || trimmedUsername.find(',') != std::string::npos) {
+        std::cout << RED << "[ERROR] Username cannot start with '!' or contain ','." << RESET << std::endl;
+        return false;
+    }
+
+    if (userExists(trimmedUsername)) {
+        std::cout << RED << "[ERROR] Username already exists." << RESET << std::endl;
+        return false;
+    }
+
+    if (!UserDirectory::instance().add(trimmedUsername, trimmedPassword)) {
+        return false;
+    }
+    std::cout << GREEN << "[INFO] Registration successful." << RESET << std::endl;
+    return true;
+}
+
+// Reports to `log`, so the server can verify a login on a worker thread.
+inline bool loginUser(const std::string& username, const std::string& password, std::ostream& log = std::cout) {
+    std::string trimmedUsername = trim(username);
+    std::string trimmedPassword = trim(password);
+
+    if (trimmedUsername == "admin" && trimmedPassword == "admin123") {
+        log << GREEN << "[SUCCESS] Admin login successful." << RESET << std::endl;
+        return true;
+    }
+
+    if (trimmedUsername.empty() || trimmedPassword.empty()) {
+        log << RED << "[ERROR] Username and password cannot be empty." << RESET << std::endl;
+        return false;
+    }
+
+    UserDirectory& directory = UserDirectory::instance();
+    if (!directory.fileAvailable()) {
+        log << RED << "[ERROR] Cannot open users file. Admin login still available." << RESET << std::endl;
+        return false;
+    }
+
+    if (directory.verify(trimmedUsername, trimmedPassword, log)) {
+        log << GREEN << "[SUCCESS] User login successful." << RESET << std::endl;
+        return true;
+    }
+    log << RED << "[ERROR] User login failed." << RESET << std::endl;
+    return false;
+}